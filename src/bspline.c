@@ -27,6 +27,7 @@
 #include <math.h>
 #include <assert.h>
 #include "bspline.h"
+#include "bspline_tab.h"
 
 #ifdef GSL_SUPPORT
 #include <gsl/gsl_poly.h>
@@ -308,21 +309,13 @@ void compute_truncation(int* trunc, const double* poles, int tn, double eps) {
 /// Constant B-spline function (KernelRadius = 0.5)
 static double BSpline0(double x, const Bspline *c) {
     (void)c; // Shut up compiler warning
-    x = fabs(x);
-    if(x < 0.5)
-        return 1;
-    if(x==0.5)
-        return 0.5;
-    return 0;
+    return bspline_tab0(x);
 }
 
 /// Linear B-spline function (KernelRadius = 1)
 static double BSpline1(double x, const Bspline *c) {
     (void)c; // Shut up compiler warning
-    x = fabs(x);
-    if(x < 1)
-        return 1-x;
-    return 0;
+    return bspline_tab1(x);
 }
 
 /// Quadratic B-spline function (KernelRadius = 1.5)
@@ -330,14 +323,7 @@ static double BSpline2Poles[1] =
     {-1.715728752538099e-1}; // -3+sqrt(8)
 static double BSpline2(double x, const Bspline *c) {
     (void)c; // Shut up compiler warning
-    x = fabs(x);
-    if(x < 0.5)
-        return 1.5 - 2*x*x;
-    if(x < 1.5) {
-        x = 1.5 - x;
-        return x*x;
-    }
-    return 0;
+    return bspline_tab2(x);
 }
 
 /// Cubic B-spline function (KernelRadius = 2)
@@ -345,14 +331,7 @@ static double BSpline3Poles[1] =
     {-2.679491924311227e-1}; // -2+sqrt(3)
 static double BSpline3(double x, const Bspline *c) {
     (void)c; // Shut up compiler warning
-    x = fabs(x);
-    if(x < 1)
-        return (4 + (-6 + 3*x)*x*x);
-    if(x < 2) {
-        x = 2 - x;
-        return x*x*x;
-    }
-    return 0;
+    return bspline_tab3(x);
 }
 
 /// Quartic B-spline function (KernelRadius = 2.5)
@@ -360,21 +339,7 @@ static double BSpline4Poles[2] =
     {-3.6134122590021989e-1,-1.3725429297339109e-2};
 static double BSpline4(double x, const Bspline *c) {
     (void)c; // Shut up compiler warning
-    x = fabs(x);
-    if(x <= 0.5) {
-        x *= x;
-        return (14.375 + (-15 + 6*x)*x);
-    }
-    if(x < 1.5) {
-        x = 1.5 - x;
-        return (1 + (4 + (6 + (4 - 4*x)*x)*x)*x);
-    }
-    if(x < 2.5) {
-        x = 2.5 - x;
-        x *= x;
-        return x*x;
-    }
-    return 0;
+    return bspline_tab4(x);
 }
 
 /// Quintic B-spline function (KernelRadius = 3)
@@ -383,21 +348,7 @@ static double BSpline5Poles[2] =
      -4.309628820326465e-2}; // sqrt(13*sqrt(105)+135)/sqrt(2)-sqrt(105)/2-13/2.
 static double BSpline5(double x, const Bspline *c) {
     (void)c; // Shut up compiler warning
-    x = fabs(x);
-    if(x <= 1) {
-        double x2 = x*x;
-        return (((-10*x + 30)*x2 - 60)*x2 + 66);
-    }
-    if(x < 2) {
-        x = 2 - x;
-        return (1 + (5 + (10 + (10 + (5 - 5*x)*x)*x)*x)*x);
-    }
-    if(x < 3) {
-        x = 3 - x;
-        double x2 = x*x;
-        return x2*x2*x;
-    }
-    return 0;
+    return bspline_tab5(x);
 }
 
 /// Sextic B-spline function (KernelRadius = 3.5)
@@ -405,25 +356,7 @@ static double BSpline6Poles[3] =
     {-4.8829458930303893e-1,-8.1679271076238694e-2,-1.4141518083257976e-3};
 static double BSpline6(double x, const Bspline *c) {
     (void)c; // Shut up compiler warning
-    x = fabs(x);
-    if(x <= 0.5) {
-        x *= x;
-        return (367.9375 + (-288.75 + (105 - 20*x)*x)*x);
-    }
-    if(x < 1.5) {
-        x = 1.5 - x;
-        return (57 + (150 + (135 + (20 + (-45 + (-30 + 15*x)*x)*x)*x)*x)*x);
-    }
-    if(x < 2.5) {
-        x = 2.5 - x;
-        return (1 + (6 + (15 + ( 20 + (15 + (6 - 6*x)*x)*x)*x)*x)*x);
-    }
-    if(x < 3.5) {
-        x = 3.5 - x;
-        x = x*x;
-        return x*x*x;
-    }
-    return 0;
+    return bspline_tab6(x);
 }
 
 /// Septic B-spline function (KernelRadius = 4)
@@ -431,27 +364,7 @@ static double BSpline7Poles[3] =
     {-5.352804307964382e-1, -1.225546151923267e-1,-9.148694809608277e-3};
 static double BSpline7(double x, const Bspline *c) {
     (void)c; // Shut up compiler warning
-    x = fabs(x);
-    if(x <= 1) {
-        double x2 = x*x;
-        return ((((35*x - 140)*x2 + 560)*x2 - 1680)*x2 + 2416);
-    }
-    if(x < 2) {
-        x = 2 - x;
-        return (120 + (392 + (504 + (280 + (-84 + (-42 +
-            21*x)*x)*x*x)*x)*x)*x);
-    }
-    if(x < 3) {
-        x = 3 - x;
-        return (((((((-7*x + 7)*x + 21)*x + 35)*x + 35)*x
-            + 21)*x + 7)*x + 1);
-    }
-    if(x < 4) {
-        x = 4 - x;
-        double x2 = x*x;
-        return x2*x2*x2*x;
-    }
-    return 0;
+    return bspline_tab7(x);
 }
 
 /// Octic B-spline function (KernelRadius = 4.5)
@@ -460,31 +373,7 @@ static double BSpline8Poles[4] =
      -2.3632294694844336e-2,-1.5382131064168442e-4};
 static double BSpline8(double x, const Bspline *c) {
     (void)c; // Shut up compiler warning
-    x = fabs(x);
-    if(x < 0.5) {
-        x *= x;
-        return (18261.7734375 + (-11379.375 + (3386.25 + (-630 + 70*x)*x)*x)*x);
-    }
-    if(x <= 1.5) {
-        x = 1.5 - x;
-        return (4293 + (8568 + (5292 + (-504 + (-1890 + (-504 + (252 + (168
-                - 56*x)*x)*x)*x)*x)*x)*x)*x);
-    }
-    if(x <= 2.5) {
-        x = 2.5 - x;
-        return (247 + (952 + (1540 + (1288 + (490 + (-56 +(-140 + (-56
-                + 28*x)*x)*x)*x)*x)*x)*x)*x);
-    }
-    if(x < 3.5) {
-        x = 3.5 - x;
-        return (1+ (8+ (28+ (56+ (70+ (56+ (28+ (8 - 8*x)*x)*x)*x)*x)*x)*x)*x);
-    }
-    if(x < 4.5) {
-        x = 4.5 - x;
-        x = x*x; x = x*x; // x^4
-        return x*x;
-    }
-    return 0;
+    return bspline_tab8(x);
 }
 
 /// Nonic B-spline function (KernelRadius = 5)
@@ -493,33 +382,7 @@ static double BSpline9Poles[4] =
      -4.322260854048175e-2,-2.121306903180818e-3};
 static double BSpline9(double x, const Bspline *c) {
     (void)c; // Shut up compiler warning
-    x = fabs(x);
-    if(x <= 1) {
-        double x2 = x*x;
-        return (((((-63*x + 315)*x2 - 2100)*x2 + 11970)*x2
-            - 44100)*x2 + 78095)*2;
-    }
-    if(x <= 2) {
-        x = 2 - x;
-        return (14608 + (36414 + (34272 + (11256 + (-4032 + (-4284 + (-672
-                + (504 + (252 - 84*x)*x)*x)*x)*x)*x)*x)*x)*x);
-    }
-    if(x <= 3) {
-        x = 3 - x;
-        return (502 + (2214 + (4248 + (4536 + (2772 + (756 + (-168 + (-216
-                + (-72 + 36*x)*x)*x)*x)*x)*x)*x)*x)*x);
-    }
-    if(x < 4) {
-        x = 4 - x;
-        return (1 + (9 + (36 + (84 + (126 + (126 + (84 + (36 + (9
-                - 9*x)*x)*x)*x)*x)*x)*x)*x)*x);
-    }
-    if(x < 5) {
-        x = 5 - x;
-        double x3 = x*x*x;
-        return x3*x3*x3;
-    }
-    return 0;
+    return bspline_tab9(x);
 }
 
 /// 10th-Degree B-spline function (KernelRadius = 5.5)
@@ -528,39 +391,7 @@ static double BSpline10Poles[5] =
      -7.528194675547741e-3,-1.698276282327549e-5};
 static double BSpline10(double x, const Bspline *c) {
     (void)c; // Shut up compiler warning
-    x = fabs(x);
-    if(x < 0.5) {
-        x *= x;
-        return (1491301.23828125 + (-769825.546875 + (191585.625 + (-30607.5
-                + (3465 - 252*x)*x)*x)*x)*x);
-    }
-    if(x <= 1.5) {
-        x = 1.5 - x;
-        return (455192+ (736260+ (327600+ (-95760 + (-119280 + (-13608
-                + (16800+ (5040+ (-1260+(-840+210*x)*x)*x)*x)*x)*x)*x)*x)*x)*x);
-    }
-    if(x <= 2.5) {
-        x = 2.5 - x;
-        return (47840 + (141060 + (171000 + (100080 + (16800 + (-13608 + (-8400
-                + (-720 + (900 + (360 - 120*x)*x)*x)*x)*x)*x)*x)*x)*x)*x);
-    }
-    if(x <= 3.5) {
-        x = 3.5 - x;
-        return (1013 + (5010 + (11025 + (14040 + (11130 + (5292 + (1050
-                + (-360 + (-315 + (-90 + 45*x)*x)*x)*x)*x)*x)*x)*x)*x)*x);
-    }
-    if(x < 4.5) {
-        x = 4.5 - x;
-        return (1 + (10 + (45 + (120 + (210 + (252 + (210 + (120 + (45 + (10
-                -10*x)*x)*x)*x)*x)*x)*x)*x)*x)*x);
-    }
-    if(x < 5.5) {
-        x = 5.5 - x;
-        x = x*x; // x2;
-        double x4 = x*x;
-        return x4*x4*x;
-    }
-    return 0;
+    return bspline_tab10(x);
 }
 
 /// 11th-Degree B-spline function (KernelRadius = 6)
@@ -569,42 +400,7 @@ static double BSpline11Poles[5] =
      -1.666962736623466e-2,-5.105575344465021e-4};
 static double BSpline11(double x, const Bspline *c) {
     (void)c; // Shut up compiler warning
-    x = fabs(x);
-    if(x <= 1) {
-        double x2 = x*x;
-        return (15724248 + (-7475160 + (1718640 + (-255024 + (27720
-            + (-2772 + 462*x)*x2)*x2)*x2)*x2)*x2);
-    }
-    if(x <= 2) {
-        x = 2 - x;
-        return (2203488 + (4480872 + (3273600 + (574200 + (-538560
-            + (-299376 + (39600 + (7920 + (-2640 + (-1320
-            + 330*x)*x)*x)*x)*x*x)*x)*x)*x)*x)*x);
-    }
-    if(x <= 3) {
-        x = 3 - x;
-        return (152637 + (515097 + (748275 + (586575 + (236610 + (12474
-            + (-34650 + (-14850 + (-495 + (1485
-            + (495-165*x)*x)*x)*x)*x)*x)*x)*x)*x)*x)*x);
-    }
-    if(x <= 4) {
-        x = 4 - x;
-        return (2036 + (11132 + (27500 + (40260 + (38280 + (24024 + (9240
-            + (1320 + (-660 + (-440 + (-110
-            + 55*x)*x)*x)*x)*x)*x)*x)*x)*x)*x)*x);
-    }
-    if(x < 5) {
-        x = 5 - x;
-        return (1 + (11 + (55 + (165 + (330 + (462 + (462 + (330 + (165
-            + (55 + (11 - 11*x)*x)*x)*x)*x)*x)*x)*x)*x)*x)*x);
-    }
-    if(x < 6) {
-        x = 6 - x;
-        double x2 = x*x;
-        double x4 = x2*x2;
-        return x4*x4*x2*x;
-    }
-    return 0;
+    return bspline_tab11(x);
 }
 
 static double (*BSplineTable[MAX_TABULATED_ORDER+1])(double, const Bspline*) = {
@@ -40,8 +40,8 @@
 /// precision specified by the user.
 ///
 /// The interpolation logic is fully contained in the Splinter library, which
-/// has no dependency. This library consists of two source files and two
-/// associated header files: bspline.[hc] and splinter.[hc]. The usage pattern
+/// has no dependency besides POSIX threads. This library consists of source
+/// files bspline.[hc], splinter.[hc] and splinter_threads.c. The usage pattern
 /// is inspired by the FFTW library:
 /// \code
 /// #include "splinter.h"
@@ -54,6 +54,8 @@
 /// interpolations can be performed by calling the \ref splinter function.
 /// Multiple image channels are supported, in which case the channels are
 /// supposed to be consecutive in memory: R...RG...GB...B for example.
+/// As in FFTW, prefiltering and transforms can use several threads, see
+/// \ref splinter_plan_with_nthreads.
 ///
 /// This is the source code of an IPOL article, where all algorithmic aspects
 /// are explained.
@@ -131,16 +133,9 @@ static int parse_geometry(double *x, double *y, int *w, int *h,
 }
 
 /// Read boundary extension
-static BoundaryExt read_ext(const char* boundary, int* larger) {
-    if(0 == strncmp(boundary, "constant", strlen(boundary))) {
-        if (*larger == 0) {
-            fprintf(stderr,"The constant extension is not compatible with ");
-            fprintf(stderr,"computations in the exact domain.\n");
-            fprintf(stderr,"\tParameter 'larger' changed to 1.\n");
-            *larger = 1;
-        }
+static BoundaryExt read_ext(const char* boundary) {
+    if(0 == strncmp(boundary, "constant", strlen(boundary)))
         return BOUNDARY_CONSTANT;
-    }
     if(0 == strncmp(boundary, "periodic", strlen(boundary)))
         return BOUNDARY_PERIODIC;
     if(0 == strncmp(boundary, "hsymmetric", strlen(boundary)))
@@ -185,7 +180,7 @@ int main(int argc, char *argv[]) {
     }
 
     eps = fix_precision(eps);
-    BoundaryExt ext = read_ext(boundary, &larger);
+    BoundaryExt ext = read_ext(boundary);
 
     // Read transformation
     double homo[9];
@@ -210,16 +205,15 @@ int main(int argc, char *argv[]) {
     double *out = malloc(Npixels*sizeof*out);
 
     unsigned long t0 = xmtime();
-    if(geom)
-        splinter_homography_geom(out, x0, y0, wout, hout,
-                                 in, w,h,c, order, ext, eps, larger, homo);
-    else
-        splinter_homography(out, in, w,h,c, order, ext, eps, larger, homo);
+    // The input image is not needed anymore: prefilter it in place
+    splinter_plan_t plan = splinter_plan_inplace(in, w,h,c, order, ext, eps,
+                                                 larger);
+    splinter_homography_with_plan(out, x0, y0, wout, hout, plan, homo);
+    splinter_destroy_plan(plan); // Frees in
     fprintf(stderr, "interpolation: %.3f s\n", (xmtime()-t0)/1000.0f);
 
     iio_write_image_double_split(filename_out, out, wout, hout, c);
 
-    free(in);
     free(out);
 
     return EXIT_SUCCESS;
@@ -0,0 +1,301 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file bspline_tab.h
+ * @brief Tabulated B-splines of small orders, as inline functions
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef BSPLINE_TAB_H
+#define BSPLINE_TAB_H
+
+/// \file bspline_tab.h
+/// B-splines of orders 0 to MAX_TABULATED_ORDER, not normalized, shared by the
+/// kernels of bspline.c and the kernels of splinter.hpp whose order is known
+/// at compile time, so that the latter can be inlined.
+
+#include <math.h>
+
+/// Constant B-spline function (KernelRadius = 0.5)
+static inline double bspline_tab0(double x) {
+    x = fabs(x);
+    if(x < 0.5)
+        return 1;
+    if(x==0.5)
+        return 0.5;
+    return 0;
+}
+
+/// Linear B-spline function (KernelRadius = 1)
+static inline double bspline_tab1(double x) {
+    x = fabs(x);
+    if(x < 1)
+        return 1-x;
+    return 0;
+}
+
+/// Quadratic B-spline function (KernelRadius = 1.5)
+static inline double bspline_tab2(double x) {
+    x = fabs(x);
+    if(x < 0.5)
+        return 1.5 - 2*x*x;
+    if(x < 1.5) {
+        x = 1.5 - x;
+        return x*x;
+    }
+    return 0;
+}
+
+/// Cubic B-spline function (KernelRadius = 2)
+static inline double bspline_tab3(double x) {
+    x = fabs(x);
+    if(x < 1)
+        return (4 + (-6 + 3*x)*x*x);
+    if(x < 2) {
+        x = 2 - x;
+        return x*x*x;
+    }
+    return 0;
+}
+
+/// Quartic B-spline function (KernelRadius = 2.5)
+static inline double bspline_tab4(double x) {
+    x = fabs(x);
+    if(x <= 0.5) {
+        x *= x;
+        return (14.375 + (-15 + 6*x)*x);
+    }
+    if(x < 1.5) {
+        x = 1.5 - x;
+        return (1 + (4 + (6 + (4 - 4*x)*x)*x)*x);
+    }
+    if(x < 2.5) {
+        x = 2.5 - x;
+        x *= x;
+        return x*x;
+    }
+    return 0;
+}
+
+/// Quintic B-spline function (KernelRadius = 3)
+static inline double bspline_tab5(double x) {
+    x = fabs(x);
+    if(x <= 1) {
+        double x2 = x*x;
+        return (((-10*x + 30)*x2 - 60)*x2 + 66);
+    }
+    if(x < 2) {
+        x = 2 - x;
+        return (1 + (5 + (10 + (10 + (5 - 5*x)*x)*x)*x)*x);
+    }
+    if(x < 3) {
+        x = 3 - x;
+        double x2 = x*x;
+        return x2*x2*x;
+    }
+    return 0;
+}
+
+/// Sextic B-spline function (KernelRadius = 3.5)
+static inline double bspline_tab6(double x) {
+    x = fabs(x);
+    if(x <= 0.5) {
+        x *= x;
+        return (367.9375 + (-288.75 + (105 - 20*x)*x)*x);
+    }
+    if(x < 1.5) {
+        x = 1.5 - x;
+        return (57 + (150 + (135 + (20 + (-45 + (-30 + 15*x)*x)*x)*x)*x)*x);
+    }
+    if(x < 2.5) {
+        x = 2.5 - x;
+        return (1 + (6 + (15 + ( 20 + (15 + (6 - 6*x)*x)*x)*x)*x)*x);
+    }
+    if(x < 3.5) {
+        x = 3.5 - x;
+        x = x*x;
+        return x*x*x;
+    }
+    return 0;
+}
+
+/// Septic B-spline function (KernelRadius = 4)
+static inline double bspline_tab7(double x) {
+    x = fabs(x);
+    if(x <= 1) {
+        double x2 = x*x;
+        return ((((35*x - 140)*x2 + 560)*x2 - 1680)*x2 + 2416);
+    }
+    if(x < 2) {
+        x = 2 - x;
+        return (120 + (392 + (504 + (280 + (-84 + (-42 +
+            21*x)*x)*x*x)*x)*x)*x);
+    }
+    if(x < 3) {
+        x = 3 - x;
+        return (((((((-7*x + 7)*x + 21)*x + 35)*x + 35)*x
+            + 21)*x + 7)*x + 1);
+    }
+    if(x < 4) {
+        x = 4 - x;
+        double x2 = x*x;
+        return x2*x2*x2*x;
+    }
+    return 0;
+}
+
+/// Octic B-spline function (KernelRadius = 4.5)
+static inline double bspline_tab8(double x) {
+    x = fabs(x);
+    if(x < 0.5) {
+        x *= x;
+        return (18261.7734375 + (-11379.375 + (3386.25 + (-630 + 70*x)*x)*x)*x);
+    }
+    if(x <= 1.5) {
+        x = 1.5 - x;
+        return (4293 + (8568 + (5292 + (-504 + (-1890 + (-504 + (252 + (168
+                - 56*x)*x)*x)*x)*x)*x)*x)*x);
+    }
+    if(x <= 2.5) {
+        x = 2.5 - x;
+        return (247 + (952 + (1540 + (1288 + (490 + (-56 +(-140 + (-56
+                + 28*x)*x)*x)*x)*x)*x)*x)*x);
+    }
+    if(x < 3.5) {
+        x = 3.5 - x;
+        return (1+ (8+ (28+ (56+ (70+ (56+ (28+ (8 - 8*x)*x)*x)*x)*x)*x)*x)*x);
+    }
+    if(x < 4.5) {
+        x = 4.5 - x;
+        x = x*x; x = x*x; // x^4
+        return x*x;
+    }
+    return 0;
+}
+
+/// Nonic B-spline function (KernelRadius = 5)
+static inline double bspline_tab9(double x) {
+    x = fabs(x);
+    if(x <= 1) {
+        double x2 = x*x;
+        return (((((-63*x + 315)*x2 - 2100)*x2 + 11970)*x2
+            - 44100)*x2 + 78095)*2;
+    }
+    if(x <= 2) {
+        x = 2 - x;
+        return (14608 + (36414 + (34272 + (11256 + (-4032 + (-4284 + (-672
+                + (504 + (252 - 84*x)*x)*x)*x)*x)*x)*x)*x)*x);
+    }
+    if(x <= 3) {
+        x = 3 - x;
+        return (502 + (2214 + (4248 + (4536 + (2772 + (756 + (-168 + (-216
+                + (-72 + 36*x)*x)*x)*x)*x)*x)*x)*x)*x);
+    }
+    if(x < 4) {
+        x = 4 - x;
+        return (1 + (9 + (36 + (84 + (126 + (126 + (84 + (36 + (9
+                - 9*x)*x)*x)*x)*x)*x)*x)*x)*x);
+    }
+    if(x < 5) {
+        x = 5 - x;
+        double x3 = x*x*x;
+        return x3*x3*x3;
+    }
+    return 0;
+}
+
+/// 10th-Degree B-spline function (KernelRadius = 5.5)
+static inline double bspline_tab10(double x) {
+    x = fabs(x);
+    if(x < 0.5) {
+        x *= x;
+        return (1491301.23828125 + (-769825.546875 + (191585.625 + (-30607.5
+                + (3465 - 252*x)*x)*x)*x)*x);
+    }
+    if(x <= 1.5) {
+        x = 1.5 - x;
+        return (455192+ (736260+ (327600+ (-95760 + (-119280 + (-13608
+                + (16800+ (5040+ (-1260+(-840+210*x)*x)*x)*x)*x)*x)*x)*x)*x)*x);
+    }
+    if(x <= 2.5) {
+        x = 2.5 - x;
+        return (47840 + (141060 + (171000 + (100080 + (16800 + (-13608 + (-8400
+                + (-720 + (900 + (360 - 120*x)*x)*x)*x)*x)*x)*x)*x)*x)*x);
+    }
+    if(x <= 3.5) {
+        x = 3.5 - x;
+        return (1013 + (5010 + (11025 + (14040 + (11130 + (5292 + (1050
+                + (-360 + (-315 + (-90 + 45*x)*x)*x)*x)*x)*x)*x)*x)*x)*x);
+    }
+    if(x < 4.5) {
+        x = 4.5 - x;
+        return (1 + (10 + (45 + (120 + (210 + (252 + (210 + (120 + (45 + (10
+                -10*x)*x)*x)*x)*x)*x)*x)*x)*x)*x);
+    }
+    if(x < 5.5) {
+        x = 5.5 - x;
+        x = x*x; // x2;
+        double x4 = x*x;
+        return x4*x4*x;
+    }
+    return 0;
+}
+
+/// 11th-Degree B-spline function (KernelRadius = 6)
+static inline double bspline_tab11(double x) {
+    x = fabs(x);
+    if(x <= 1) {
+        double x2 = x*x;
+        return (15724248 + (-7475160 + (1718640 + (-255024 + (27720
+            + (-2772 + 462*x)*x2)*x2)*x2)*x2)*x2);
+    }
+    if(x <= 2) {
+        x = 2 - x;
+        return (2203488 + (4480872 + (3273600 + (574200 + (-538560
+            + (-299376 + (39600 + (7920 + (-2640 + (-1320
+            + 330*x)*x)*x)*x)*x*x)*x)*x)*x)*x)*x);
+    }
+    if(x <= 3) {
+        x = 3 - x;
+        return (152637 + (515097 + (748275 + (586575 + (236610 + (12474
+            + (-34650 + (-14850 + (-495 + (1485
+            + (495-165*x)*x)*x)*x)*x)*x)*x)*x)*x)*x)*x);
+    }
+    if(x <= 4) {
+        x = 4 - x;
+        return (2036 + (11132 + (27500 + (40260 + (38280 + (24024 + (9240
+            + (1320 + (-660 + (-440 + (-110
+            + 55*x)*x)*x)*x)*x)*x)*x)*x)*x)*x)*x);
+    }
+    if(x < 5) {
+        x = 5 - x;
+        return (1 + (11 + (55 + (165 + (330 + (462 + (462 + (330 + (165
+            + (55 + (11 - 11*x)*x)*x)*x)*x)*x)*x)*x)*x)*x)*x);
+    }
+    if(x < 6) {
+        x = 6 - x;
+        double x2 = x*x;
+        double x4 = x2*x2;
+        return x4*x4*x2*x;
+    }
+    return 0;
+}
+
+#endif
@@ -25,14 +25,192 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 #include "homography_tools.h"
 
+/// Read a line of any length from \a f. Return NULL at end of file or if
+/// out of memory (then *\a error is set).
+static char* read_line(FILE* f, int* error) {
+    size_t n = 0, size = 256;
+    char* line = malloc(size);
+    int ch;
+    if(! line) {
+        *error = 1;
+        return NULL;
+    }
+    while((ch = fgetc(f)) != EOF && ch != '\n') {
+        if(n+1 == size) {
+            char* l = realloc(line, size *= 2);
+            if(! l) {
+                free(line);
+                *error = 1;
+                return NULL;
+            }
+            line = l;
+        }
+        line[n++] = (char)ch;
+    }
+    if(ch == EOF && n == 0) {
+        free(line);
+        return NULL;
+    }
+    line[n] = 0;
+    return line;
+}
+
+/// Dynamic array of doubles, growing geometrically
+typedef struct {
+    double* v; ///< values
+    int n, capacity; ///< number of values, allocated size
+} doubles_t;
+
+/// Dynamic array of integers, growing geometrically
+typedef struct {
+    int* v; ///< values
+    int n, capacity; ///< number of values, allocated size
+} ints_t;
+
+/// New capacity of an array of \a capacity elements to hold \a n
+static int grown(int capacity, int n) {
+    if(capacity < 16)
+        capacity = 16;
+    while(capacity < n)
+        capacity *= 2;
+    return capacity;
+}
+
+/// Append \a n values to \a a. Return 0 if out of memory.
+static int push_doubles(doubles_t* a, const double* v, int n) {
+    if(a->n+n > a->capacity) {
+        int capacity = grown(a->capacity, a->n+n);
+        double* p = realloc(a->v, capacity*sizeof*p);
+        if(! p)
+            return 0;
+        a->v = p;
+        a->capacity = capacity;
+    }
+    for(int i=0; i<n; i++)
+        a->v[a->n++] = v[i];
+    return 1;
+}
+
+/// Append value \a v to \a a. Return 0 if out of memory.
+static int push_int(ints_t* a, int v) {
+    if(a->n+1 > a->capacity) {
+        int capacity = grown(a->capacity, a->n+1);
+        int* p = realloc(a->v, capacity*sizeof*p);
+        if(! p)
+            return 0;
+        a->v = p;
+        a->capacity = capacity;
+    }
+    a->v[a->n++] = v;
+    return 1;
+}
+
+/// Parse one line of correspondences into \a values (emptied first).
+/// Return 1 if they are 4 or more x y hx hy, 0 for a blank or comment line,
+/// -1 for a syntax error and -2 if out of memory.
+static int parse_line(const char* line, doubles_t* values) {
+    const char* p = line;
+    char* end;
+    values->n = 0;
+    while(1) {
+        double x = strtod(p, &end);
+        if(end == p)
+            break;
+        if(! push_doubles(values, &x, 1))
+            return -2;
+        p = end;
+    }
+    while(*p == ' ' || *p == '\t' || *p == '\r')
+        ++p;
+    int n = values->n;
+    if(n == 0 && (*p == 0 || *p == '#'))
+        return 0;
+    return (*p == 0 && n%4 == 0 && n >= 16)? 1: -1;
+}
+
+/// Batch mode: each line of \a f has 4 or more correspondences
+/// "x y hx hy", a homography is printed for each line. Sets of 4 are solved
+/// exactly, larger ones by normalized DLT. Empty lines and those starting
+/// with # are ignored.
+static int batch(FILE* f) {
+    doubles_t src4={0}, dst4={0}, src={0}, dst={0}, values={0};
+    ints_t kind={0}, start={0};
+    int lineNo=0, status=1, error=0;
+    char* line;
+    if(! push_int(&start, 0))
+        status = -2;
+    while(status > 0 && (line = read_line(f, &error)) != NULL) {
+        ++lineNo;
+        status = parse_line(line, &values);
+        free(line);
+        if(status <= 0) {
+            if(status == -1)
+                fprintf(stderr, "Line %d: expected 4 or more x y hx hy\n",
+                        lineNo);
+            status = (status == 0)? 1: status;
+            continue;
+        }
+        int n = values.n, ok = push_int(&kind, n == 16);
+        for(int i=0; ok && i<n; i+=4)
+            if(n == 16)
+                ok = push_doubles(&src4, values.v+i, 2) &&
+                    push_doubles(&dst4, values.v+i+2, 2);
+            else
+                ok = push_doubles(&src, values.v+i, 2) &&
+                    push_doubles(&dst, values.v+i+2, 2);
+        if(ok && n != 16)
+            ok = push_int(&start, src.n/2);
+        if(! ok)
+            status = -2;
+    }
+    int n4 = src4.n/8, nDlt = start.n-1;
+    double* H4 = NULL, *H = NULL;
+    if(status > 0 && !error) {
+        H4 = malloc((size_t)9*n4*sizeof(double));
+        H = malloc((size_t)9*nDlt*sizeof(double));
+        if(!H4 || !H)
+            error = 1;
+    }
+    if(status > 0 && !error) {
+        homographies_from_4corresp(n4, src4.v, dst4.v, H4);
+        if(homographies_dlt(nDlt, start.v, src.v, dst.v, H) > 0)
+            fprintf(stderr, "Warning: degenerate correspondences\n");
+        for(int l=0, i4=0, i=0; l<kind.n; l++) {
+            const double* R = kind.v[l]? H4+9*i4++: H+9*i++;
+            for(int j=0; j<9; j++)
+                printf("%1.16lg%c", R[j], j==8?'\n':' ');
+        }
+    }
+    if(status == -2 || error)
+        fprintf(stderr, "Not enough memory\n");
+    free(H4); free(H);
+    free(values.v); free(src4.v); free(dst4.v); free(src.v); free(dst.v);
+    free(kind.v); free(start.v);
+    return (status > 0 && !error)? EXIT_SUCCESS: EXIT_FAILURE;
+}
+
 /// Computation of the homography from 4 correspondances
 int main(int c, char *v[])
 {
+    if (c == 3 && strcmp(v[1], "-f") == 0) {
+        FILE* f = strcmp(v[2], "-")? fopen(v[2], "r"): stdin;
+        if (!f) {
+            fprintf(stderr, "Unable to open file %s\n", v[2]);
+            return EXIT_FAILURE;
+        }
+        int res = batch(f);
+        if (f != stdin)
+            fclose(f);
+        return res;
+    }
     if (c != 17) {
             fprintf(stderr, "usage:\n\t%s x1 y1 hx1 hy1 x2 y2 hx2 hy2 x3 y3 hx3 hy3\n", *v);
             fprintf(stderr, "x4 y4 hx4 hy4\n");
+            fprintf(stderr, "or\t%s -f file   (one set of >=4 x y hx hy per "
+                    "line, - for stdin)\n", *v);
             return EXIT_FAILURE;
     }
 
@@ -22,6 +22,13 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <math.h>
+#include "homography_tools.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
 /// Compute inverse homography
 void invert_homography(double iH[9], const double H[9]) {
   double det = H[0] * (H[4]*H[8] - H[5] * H[7]);
@@ -51,9 +58,9 @@ void apply_homography(double y[2], const double x[2], const double H[9]) {
 }
 
 /// Compute the homography sending [0,0] , [0,1], [1,1] and [1,0] to x,y,z,w.
-static void homography_from_4pt(const double *x, const double *y,
-                                const double *z, const double *w,
-                                double cgret[8]) {
+static inline void homography_from_4pt(const double *x, const double *y,
+                                       const double *z, const double *w,
+                                       double cgret[8]) {
     double t1 = x[0];
     double t2 = z[0];
     double t4 = y[1];
@@ -96,43 +103,333 @@ static void homography_from_4pt(const double *x, const double *y,
     //cgret[8] = 1;
 }
 
-/// Compute homogaphy from 4 corresponding points.
-void homography_from_4corresp(
-    const double *a, const double *b, const double *c, const double *d,
-    const double *x, const double *y, const double *z, const double *w,
-    double R[3][3]) {
-    double Hr[3][3], Hl[3][3];
-
-    homography_from_4pt(a,b,c,d,&Hr[0][0]);
-    homography_from_4pt(x,y,z,w,&Hl[0][0]);
-
-    // the following code computes R = Hl * inverse Hr
-    double t2 = Hr[1][1]-Hr[2][1]*Hr[1][2];
-    double t4 = Hr[0][0]*Hr[1][1];
-    double t5 = Hr[0][0]*Hr[1][2];
-    double t7 = Hr[1][0]*Hr[0][1];
-    double t8 = Hr[0][2]*Hr[1][0];
-    double t10 = Hr[0][1]*Hr[2][0];
-    double t12 = Hr[0][2]*Hr[2][0];
-    double t15 = 1/(t4-t5*Hr[2][1]-t7+t8*Hr[2][1]+t10*Hr[1][2]-t12*Hr[1][1]);
-    double t18 = -Hr[1][0]+Hr[1][2]*Hr[2][0];
-    double t23 = -Hr[1][0]*Hr[2][1]+Hr[1][1]*Hr[2][0];
-    double t28 = -Hr[0][1]+Hr[0][2]*Hr[2][1];
-    double t31 = Hr[0][0]-t12;
-    double t35 = Hr[0][0]*Hr[2][1]-t10;
-    double t41 = -Hr[0][1]*Hr[1][2]+Hr[0][2]*Hr[1][1];
+/// Compose R = Hl * inverse Hr, with Hr and Hl given by \ref
+/// homography_from_4pt.
+static inline void compose_4pt(const double Hr[8], const double Hl[8],
+                               double R[9]) {
+    double t2 = Hr[4]-Hr[7]*Hr[5];
+    double t4 = Hr[0]*Hr[4];
+    double t5 = Hr[0]*Hr[5];
+    double t7 = Hr[3]*Hr[1];
+    double t8 = Hr[2]*Hr[3];
+    double t10 = Hr[1]*Hr[6];
+    double t12 = Hr[2]*Hr[6];
+    double t15 = 1/(t4-t5*Hr[7]-t7+t8*Hr[7]+t10*Hr[5]-t12*Hr[4]);
+    double t18 = -Hr[3]+Hr[5]*Hr[6];
+    double t23 = -Hr[3]*Hr[7]+Hr[4]*Hr[6];
+    double t28 = -Hr[1]+Hr[2]*Hr[7];
+    double t31 = Hr[0]-t12;
+    double t35 = Hr[0]*Hr[7]-t10;
+    double t41 = -Hr[1]*Hr[5]+Hr[2]*Hr[4];
     double t44 = t5-t8;
     double t47 = t4-t7;
     double t48 = t2*t15;
     double t49 = t28*t15;
     double t50 = t41*t15;
-    R[0][0] = Hl[0][0]*t48+Hl[0][1]*(t18*t15)-Hl[0][2]*(t23*t15);
-    R[0][1] = Hl[0][0]*t49+Hl[0][1]*(t31*t15)-Hl[0][2]*(t35*t15);
-    R[0][2] = -Hl[0][0]*t50-Hl[0][1]*(t44*t15)+Hl[0][2]*(t47*t15);
-    R[1][0] = Hl[1][0]*t48+Hl[1][1]*(t18*t15)-Hl[1][2]*(t23*t15);
-    R[1][1] = Hl[1][0]*t49+Hl[1][1]*(t31*t15)-Hl[1][2]*(t35*t15);
-    R[1][2] = -Hl[1][0]*t50-Hl[1][1]*(t44*t15)+Hl[1][2]*(t47*t15);
-    R[2][0] = Hl[2][0]*t48+Hl[2][1]*(t18*t15)-t23*t15;
-    R[2][1] = Hl[2][0]*t49+Hl[2][1]*(t31*t15)-t35*t15;
-    R[2][2] = -Hl[2][0]*t50-Hl[2][1]*(t44*t15)+t47*t15;
+    R[0] = Hl[0]*t48+Hl[1]*(t18*t15)-Hl[2]*(t23*t15);
+    R[1] = Hl[0]*t49+Hl[1]*(t31*t15)-Hl[2]*(t35*t15);
+    R[2] = -Hl[0]*t50-Hl[1]*(t44*t15)+Hl[2]*(t47*t15);
+    R[3] = Hl[3]*t48+Hl[4]*(t18*t15)-Hl[5]*(t23*t15);
+    R[4] = Hl[3]*t49+Hl[4]*(t31*t15)-Hl[5]*(t35*t15);
+    R[5] = -Hl[3]*t50-Hl[4]*(t44*t15)+Hl[5]*(t47*t15);
+    R[6] = Hl[6]*t48+Hl[7]*(t18*t15)-t23*t15;
+    R[7] = Hl[6]*t49+Hl[7]*(t31*t15)-t35*t15;
+    R[8] = -Hl[6]*t50-Hl[7]*(t44*t15)+t47*t15;
+}
+
+/// Compute homogaphy from 4 corresponding points.
+void homography_from_4corresp(
+    const double *a, const double *b, const double *c, const double *d,
+    const double *x, const double *y, const double *z, const double *w,
+    double R[3][3]) {
+    double Hr[8], Hl[8];
+
+    homography_from_4pt(a,b,c,d,Hr);
+    homography_from_4pt(x,y,z,w,Hl);
+
+    compose_4pt(Hr, Hl, (double*)R);
+}
+
+/// \brief Compute homographies of \a n problems of 4 correspondences.
+/// \details Problem k maps the 4 points src[8k..8k+7] (x,y interleaved) to
+/// dst[8k..8k+7], its homography is written in H[9k..9k+8]. Problems are
+/// independent and the closed form, inlined without branches or calls, is
+/// vectorized across problems by the compiler (with -O3).
+void homographies_from_4corresp(int n, const double* restrict src,
+                                const double* restrict dst,
+                                double* restrict H) {
+    for(int k=0; k<n; k++) {
+        const double *a = src+8*k, *x = dst+8*k;
+        double Hr[8], Hl[8];
+        homography_from_4pt(a, a+2, a+4, a+6, Hr);
+        homography_from_4pt(x, x+2, x+4, x+6, Hl);
+        compose_4pt(Hr, Hl, H+9*k);
+    }
+}
+
+/// Similarity T of Hartley normalization: the \a n points \a p are centered
+/// at the origin and their mean distance to it is sqrt(2). Return 0 if all
+/// points coincide, up to the rounding errors of the centroid.
+static int normalization(int n, const double* p, double T[9]) {
+    double cx=0, cy=0, d=0;
+    for(int i=0; i<n; i++) {
+        cx += p[2*i];
+        cy += p[2*i+1];
+    }
+    cx /= n;
+    cy /= n;
+    for(int i=0; i<n; i++)
+        d += hypot(p[2*i]-cx, p[2*i+1]-cy);
+    if(! (d > 1e-12*n*(1+fabs(cx)+fabs(cy))))
+        return 0;
+    double s = sqrt(2.0)*n/d;
+    double S[9] = {s, 0, -s*cx, 0, s, -s*cy, 0, 0, 1};
+    for(int i=0; i<9; i++)
+        T[i] = S[i];
+    return 1;
+}
+
+/// Eigenvector \a v of smallest eigenvalue of symmetric 9x9 matrix \a A,
+/// by cyclic Jacobi rotations. \a A is destroyed.
+static void smallest_eigenvector(double A[9][9], double v[9]) {
+    double V[9][9];
+    for(int i=0; i<9; i++)
+        for(int j=0; j<9; j++)
+            V[i][j] = (i==j);
+    for(int sweep=0; sweep<50; sweep++) {
+        double off=0, diag=0;
+        for(int i=0; i<9; i++) {
+            diag += A[i][i]*A[i][i];
+            for(int j=i+1; j<9; j++)
+                off += A[i][j]*A[i][j];
+        }
+        if(off <= 1e-30*diag)
+            break;
+        for(int p=0; p<8; p++)
+            for(int q=p+1; q<9; q++) {
+                if(A[p][q] == 0)
+                    continue;
+                double theta = (A[q][q]-A[p][p])/(2*A[p][q]);
+                double t = (theta>=0? 1: -1)/(fabs(theta)+sqrt(theta*theta+1));
+                double c = 1/sqrt(t*t+1), s = t*c;
+                for(int k=0; k<9; k++) { // A <- A J
+                    double akp = A[k][p], akq = A[k][q];
+                    A[k][p] = c*akp - s*akq;
+                    A[k][q] = s*akp + c*akq;
+                }
+                for(int k=0; k<9; k++) { // A <- J^T A
+                    double apk = A[p][k], aqk = A[q][k];
+                    A[p][k] = c*apk - s*aqk;
+                    A[q][k] = s*apk + c*aqk;
+                }
+                for(int k=0; k<9; k++) {
+                    double vkp = V[k][p], vkq = V[k][q];
+                    V[k][p] = c*vkp - s*vkq;
+                    V[k][q] = s*vkp + c*vkq;
+                }
+            }
+    }
+    int m = 0;
+    for(int i=1; i<9; i++)
+        if(A[i][i] < A[m][m])
+            m = i;
+    for(int i=0; i<9; i++)
+        v[i] = V[i][m];
+}
+
+/// Product C = A B of 3x3 matrices
+static void product(double C[9], const double A[9], const double B[9]) {
+    for(int i=0; i<3; i++)
+        for(int j=0; j<3; j++)
+            C[3*i+j] = A[3*i]*B[j] + A[3*i+1]*B[3+j] + A[3*i+2]*B[6+j];
+}
+
+/// Normal matrix M of the DLT of \a n points \a src to \a dst, after their
+/// normalizations T1 and T2. Return 0 if n<4 or the points of a set coincide.
+static int dlt_normal_matrix(int n, const double* src, const double* dst,
+                             double T1[9], double T2[9], double M[9][9]) {
+    if(n < 4 || !normalization(n, src, T1) || !normalization(n, dst, T2))
+        return 0;
+    // A^T A, where A has rows (-x,-y,-1,0,0,0,ux,uy,u) and
+    // (0,0,0,-x,-y,-1,vx,vy,v)
+    for(int i=0; i<9; i++)
+        for(int j=0; j<9; j++)
+            M[i][j] = 0;
+    for(int k=0; k<n; k++) {
+        double x = T1[0]*src[2*k]+T1[2], y = T1[4]*src[2*k+1]+T1[5];
+        double u = T2[0]*dst[2*k]+T2[2], v = T2[4]*dst[2*k+1]+T2[5];
+        double r[2][9] = {{-x,-y,-1, 0, 0, 0, u*x, u*y, u},
+                          { 0, 0, 0,-x,-y,-1, v*x, v*y, v}};
+        for(int l=0; l<2; l++)
+            for(int i=0; i<9; i++)
+                for(int j=i; j<9; j++)
+                    M[i][j] += r[l][i]*r[l][j];
+    }
+    for(int i=0; i<9; i++)
+        for(int j=0; j<i; j++)
+            M[i][j] = M[j][i];
+    return 1;
+}
+
+/// Homography H = T2^-1 h T1 from the solution \a h of the normalized DLT,
+/// scaled so that H[8]=1 when possible.
+static void dlt_denormalize(const double h[9], const double T1[9],
+                            const double T2[9], double H[9]) {
+    double iT2[9], tmp[9];
+    invert_homography(iT2, T2);
+    product(tmp, h, T1);
+    product(H, iT2, tmp);
+    if(H[8] != 0) {
+        double s = 1/H[8];
+        for(int i=0; i<9; i++)
+            H[i] *= s;
+    }
+}
+
+/// \brief Least-squares homography mapping \a n>=4 points \a src to \a dst
+/// (x,y interleaved) by the normalized direct linear transform.
+/// \details The algebraic error is minimized after Hartley normalization of
+/// both point sets. H is scaled so that H[8]=1 when possible. Return 0 on
+/// success, -1 if n<4 or the points of a set coincide (H is then NaN).
+int homography_dlt(int n, const double* src, const double* dst, double H[9]) {
+    double T1[9], T2[9], M[9][9], h[9];
+    if(! dlt_normal_matrix(n, src, dst, T1, T2, M)) {
+        for(int i=0; i<9; i++)
+            H[i] = NAN;
+        return -1;
+    }
+    smallest_eigenvector(M, h);
+    dlt_denormalize(h, T1, T2, H);
+    return 0;
+}
+
+#define DLT_LANES 8 ///< Problems solved together by \ref homographies_dlt
+
+/// \brief Eigenvectors \a v of smallest eigenvalue of DLT_LANES symmetric
+/// 9x9 matrices, lane l of A[i][j][l] being matrix l.
+/// \details Same cyclic Jacobi rotations as \ref smallest_eigenvector,
+/// applied to all lanes at once, so that the updates are vectorized across
+/// problems by the compiler (with -O3). The sweeps stop when all lanes have
+/// converged. \a A is destroyed.
+static void smallest_eigenvectors(double A[9][9][DLT_LANES],
+                                  double v[9][DLT_LANES]) {
+    double V[9][9][DLT_LANES];
+    for(int i=0; i<9; i++)
+        for(int j=0; j<9; j++)
+            for(int l=0; l<DLT_LANES; l++)
+                V[i][j][l] = (i==j);
+    for(int sweep=0; sweep<50; sweep++) {
+        int converged = 1;
+        for(int l=0; l<DLT_LANES; l++) {
+            double off=0, diag=0;
+            for(int i=0; i<9; i++) {
+                diag += A[i][i][l]*A[i][i][l];
+                for(int j=i+1; j<9; j++)
+                    off += A[i][j][l]*A[i][j][l];
+            }
+            converged &= (off <= 1e-30*diag);
+        }
+        if(converged)
+            break;
+        for(int p=0; p<8; p++)
+            for(int q=p+1; q<9; q++) {
+                double c[DLT_LANES], s[DLT_LANES];
+                for(int l=0; l<DLT_LANES; l++) { // Identity if A[p][q]=0
+                    double apq = A[p][q][l], zero = (apq == 0);
+                    double theta = (A[q][q][l]-A[p][p][l])/(2*apq + zero);
+                    double t = (1-zero)*copysign(1, theta)/
+                        (fabs(theta)+sqrt(theta*theta+1));
+                    c[l] = 1/sqrt(t*t+1);
+                    s[l] = t*c[l];
+                }
+                for(int k=0; k<9; k++) // A <- A J
+                    for(int l=0; l<DLT_LANES; l++) {
+                        double akp = A[k][p][l], akq = A[k][q][l];
+                        A[k][p][l] = c[l]*akp - s[l]*akq;
+                        A[k][q][l] = s[l]*akp + c[l]*akq;
+                    }
+                for(int k=0; k<9; k++) // A <- J^T A
+                    for(int l=0; l<DLT_LANES; l++) {
+                        double apk = A[p][k][l], aqk = A[q][k][l];
+                        A[p][k][l] = c[l]*apk - s[l]*aqk;
+                        A[q][k][l] = s[l]*apk + c[l]*aqk;
+                    }
+                for(int k=0; k<9; k++)
+                    for(int l=0; l<DLT_LANES; l++) {
+                        double vkp = V[k][p][l], vkq = V[k][q][l];
+                        V[k][p][l] = c[l]*vkp - s[l]*vkq;
+                        V[k][q][l] = s[l]*vkp + c[l]*vkq;
+                    }
+            }
+    }
+    for(int l=0; l<DLT_LANES; l++) {
+        int m = 0;
+        for(int i=1; i<9; i++)
+            if(A[i][i][l] < A[m][m][l])
+                m = i;
+        for(int i=0; i<9; i++)
+            v[i][l] = V[i][m][l];
+    }
+}
+
+/// \brief Least-squares homographies of \a n problems, see \ref homography_dlt.
+/// \details Problem k has the correspondences of indices start[k] to
+/// start[k+1]-1 in \a src and \a dst (x,y interleaved), its homography is
+/// written in H[9k..9k+8]. Return the number of degenerate problems.
+/// The normal matrices are built problem by problem, then the eigenvectors
+/// of groups of DLT_LANES problems are computed together.
+int homographies_dlt(int n, const int* start,
+                     const double* src, const double* dst, double* H) {
+    int fails = 0;
+    for(int k0=0; k0<n; k0+=DLT_LANES) {
+        double A[9][9][DLT_LANES], v[9][DLT_LANES], M[9][9];
+        double T1[DLT_LANES][9], T2[DLT_LANES][9];
+        int valid[DLT_LANES];
+        for(int l=0; l<DLT_LANES; l++) {
+            int k = k0+l;
+            valid[l] = (k < n &&
+                        dlt_normal_matrix(start[k+1]-start[k], src+2*start[k],
+                                          dst+2*start[k], T1[l], T2[l], M));
+            for(int i=0; i<9; i++) // Identity for lanes without problem
+                for(int j=0; j<9; j++)
+                    A[i][j][l] = valid[l]? M[i][j]: (i==j);
+        }
+        smallest_eigenvectors(A, v);
+        for(int l=0; l<DLT_LANES && k0+l<n; l++) {
+            double* Hk = H+9*(k0+l);
+            if(! valid[l]) {
+                for(int i=0; i<9; i++)
+                    Hk[i] = NAN;
+                ++fails;
+                continue;
+            }
+            double h[9];
+            for(int i=0; i<9; i++)
+                h[i] = v[i][l];
+            dlt_denormalize(h, T1[l], T2[l], Hk);
+        }
+    }
+    return fails;
+}
+
+/// Typical homography of given class for an image of size w x h:
+/// translation by a subpixel vector, rotation by 30 degrees about the center,
+/// or strong perspective sending the top corners closer to each other.
+void homography_of_class(double H[9], HomographyClass type, int w, int h) {
+    double cx = w/2.0, cy = h/2.0, a = M_PI/6;
+    double T[2][9] = {
+        {1, 0, 0.5, 0, 1, 0.25, 0, 0, 1},
+        {cos(a), -sin(a), cx-cos(a)*cx+sin(a)*cy,
+         sin(a),  cos(a), cy-sin(a)*cx-cos(a)*cy, 0, 0, 1}
+    };
+    if(type == HOMOGRAPHY_PERSPECTIVE) {
+        double a0[2]={0,0}, a1[2]={w,0}, a2[2]={w,h}, a3[2]={0,h};
+        double b0[2]={0.3*w,0.1*h}, b1[2]={0.7*w,0.1*h};
+        double R[3][3];
+        homography_from_4corresp(a0,a1,a2,a3, b0,b1,a2,a3, R);
+        for(int i=0; i<9; i++)
+            H[i] = R[i/3][i%3];
+    } else
+        for(int i=0; i<9; i++)
+            H[i] = T[type][i];
 }
@@ -25,6 +25,13 @@
 #ifndef HOMOGRAPHYTOOLS_H
 #define HOMOGRAPHYTOOLS_H
 
+/// Classes of homographies used for benchmarks
+typedef enum {
+    HOMOGRAPHY_TRANSLATION = 0, ///< subpixel translation
+    HOMOGRAPHY_ROTATION = 1, ///< rotation about image center
+    HOMOGRAPHY_PERSPECTIVE = 2 ///< strong perspective
+} HomographyClass;
+
 void invert_homography(double iH[9], const double H[9]);
 void apply_homography(double y[2], const double x[2], const double H[9]);
 void homography_from_4corresp(const double *a, const double *b,
@@ -32,5 +39,12 @@ void homography_from_4corresp(const double *a, const double *b,
                               const double *x, const double *y,
                               const double *z, const double *w,
                               double R[3][3]);
+void homographies_from_4corresp(int n, const double* restrict src,
+                                const double* restrict dst,
+                                double* restrict H);
+int homography_dlt(int n, const double* src, const double* dst, double H[9]);
+int homographies_dlt(int n, const int* start,
+                     const double* src, const double* dst, double* H);
+void homography_of_class(double H[9], HomographyClass type, int w, int h);
 
 #endif
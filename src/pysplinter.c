@@ -0,0 +1,325 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file pysplinter.c
+ * @brief Python module for spline interpolation
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// \file pysplinter.c
+/// Thin binding of the Splinter library. Images are accessed through the
+/// buffer protocol (NumPy arrays, memoryviews...) without copy: shape (h,w)
+/// for a single channel, (h,w,c) for interleaved or (c,h,w) for planar
+/// channels, with any strides, of type float64 or float32. The GIL is released
+/// during computations, so that Python threads can interpolate in parallel.
+/// \code
+/// import numpy as np, splinter
+/// plan = splinter.Plan(image, order=11, boundary="hsymmetric", eps=1e-6)
+/// out = np.empty_like(image)
+/// plan.warp([1,0,0.5, 0,1,0, 0,0,1], out)
+/// \endcode
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <string.h>
+#include "splinter_transform.h"
+
+/// Python object wrapping a plan
+typedef struct {
+    PyObject_HEAD
+    splinter_plan_t plan; ///< The plan
+    int valid; ///< Whether plan was created
+} PlanObject;
+
+/// Read boundary extension, abridged names are accepted
+static int parse_boundary(const char* s, BoundaryExt* e) {
+    const char* names[] = {"constant", "hsymmetric", "wsymmetric", "periodic"};
+    for(int i=0; i<4; i++)
+        if(*s && 0 == strncmp(s, names[i], strlen(s))) {
+            *e = (BoundaryExt)i;
+            return 0;
+        }
+    PyErr_Format(PyExc_ValueError, "Unknown boundary condition %s", s);
+    return -1;
+}
+
+/// Get image dimensions and layout of buffer \a b. Return 0 on success.
+static int buffer_layout(const Py_buffer* b, int channelsLast,
+                         int* w, int* h, int* c, splinter_layout_t* l) {
+    char f = b->format? b->format[strlen(b->format)-1]: 'B';
+    if(f == 'd' && b->itemsize == sizeof(double))
+        l->type = SPLINTER_FLOAT64;
+    else if(f == 'f' && b->itemsize == sizeof(float))
+        l->type = SPLINTER_FLOAT32;
+    else {
+        PyErr_SetString(PyExc_TypeError, "Image must be float64 or float32");
+        return -1;
+    }
+    if(b->ndim != 2 && b->ndim != 3) {
+        PyErr_SetString(PyExc_ValueError, "Image must have 2 or 3 dimensions");
+        return -1;
+    }
+    for(int i=0; i<b->ndim; i++)
+        if(b->strides[i] % b->itemsize) {
+            PyErr_SetString(PyExc_ValueError, "Unaligned strides");
+            return -1;
+        }
+    int iy=0, ix=1, ic=2; // Axes
+    if(b->ndim == 3 && !channelsLast) {
+        ic=0; iy=1; ix=2;
+    }
+    *h = (int)b->shape[iy];
+    *w = (int)b->shape[ix];
+    *c = (b->ndim == 3)? (int)b->shape[ic]: 1;
+    l->yStride = b->strides[iy] / b->itemsize;
+    l->xStride = b->strides[ix] / b->itemsize;
+    l->cStride = (b->ndim == 3)? b->strides[ic] / b->itemsize: 0;
+    return 0;
+}
+
+/// Read 9 coefficients of homography from a buffer or a sequence
+static int parse_homography(PyObject* o, double H[9]) {
+    Py_buffer b;
+    if(0 == PyObject_GetBuffer(o, &b, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT)) {
+        int ok = (b.len == 9*sizeof(double) && b.format &&
+                  b.format[strlen(b.format)-1] == 'd');
+        if(ok)
+            memcpy(H, b.buf, 9*sizeof(double));
+        PyBuffer_Release(&b);
+        if(ok)
+            return 0;
+    }
+    PyErr_Clear();
+    PyObject* seq = PySequence_Fast(o, "Homography must be a sequence");
+    if(! seq)
+        return -1;
+    if(PySequence_Fast_GET_SIZE(seq) != 9) {
+        Py_DECREF(seq);
+        PyErr_SetString(PyExc_ValueError, "Homography must have 9 values");
+        return -1;
+    }
+    for(int i=0; i<9; i++)
+        H[i] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(seq, i));
+    Py_DECREF(seq);
+    return PyErr_Occurred()? -1: 0;
+}
+
+/// Plan(image, order=11, boundary="hsymmetric", eps=1e-6, larger=False,
+///      channels_last=True)
+/// A plan cannot be initialized again, since other threads may be using it
+/// with the GIL released.
+static int Plan_init(PlanObject* self, PyObject* args, PyObject* kwds) {
+    static char* kwlist[] = {"image", "order", "boundary", "eps", "larger",
+                             "channels_last", NULL};
+    PyObject* image;
+    int order = MAX_TABULATED_ORDER, larger = 0, channelsLast = 1;
+    const char* boundary = "hsymmetric";
+    double eps = 1e-6;
+    if(! PyArg_ParseTupleAndKeywords(args, kwds, "O|isdpp", kwlist, &image,
+                                     &order, &boundary, &eps, &larger,
+                                     &channelsLast))
+        return -1;
+    if(self->valid) {
+        PyErr_SetString(PyExc_RuntimeError, "Plan already initialized");
+        return -1;
+    }
+    BoundaryExt e;
+    if(parse_boundary(boundary, &e))
+        return -1;
+    if(order < 0 || order > MAX_TABULATED_ORDER) {
+        PyErr_Format(PyExc_ValueError, "Order must be in [0,%d]",
+                     MAX_TABULATED_ORDER);
+        return -1;
+    }
+    Py_buffer b;
+    if(PyObject_GetBuffer(image, &b, PyBUF_STRIDES | PyBUF_FORMAT))
+        return -1;
+    int w, h, c;
+    splinter_layout_t layout;
+    if(buffer_layout(&b, channelsLast, &w, &h, &c, &layout)) {
+        PyBuffer_Release(&b);
+        return -1;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    self->plan = splinter_plan_layout(b.buf, layout, w, h, c,
+                                      order, e, eps, larger);
+    Py_END_ALLOW_THREADS
+    self->valid = 1;
+    PyBuffer_Release(&b);
+    return 0;
+}
+
+/// Dispose of plan
+static void Plan_dealloc(PlanObject* self) {
+    if(self->valid)
+        splinter_destroy_plan(self->plan);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+/// Check that the plan was initialized
+static int check_valid(PlanObject* self) {
+    if(! self->valid)
+        PyErr_SetString(PyExc_RuntimeError, "Plan not initialized");
+    return self->valid? 0: -1;
+}
+
+/// warp(H, out, x0=0, y0=0, channels_last=True)
+static PyObject* Plan_warp(PlanObject* self, PyObject* args, PyObject* kwds) {
+    static char* kwlist[] = {"H", "out", "x0", "y0", "channels_last", NULL};
+    PyObject *homo, *out;
+    double x0=0, y0=0, H[9];
+    int channelsLast = 1;
+    if(! PyArg_ParseTupleAndKeywords(args, kwds, "OO|ddp", kwlist, &homo, &out,
+                                     &x0, &y0, &channelsLast))
+        return NULL;
+    if(check_valid(self) || parse_homography(homo, H))
+        return NULL;
+    Py_buffer b;
+    if(PyObject_GetBuffer(out, &b, PyBUF_STRIDES|PyBUF_FORMAT|PyBUF_WRITABLE))
+        return NULL;
+    int w, h, c;
+    splinter_layout_t layout;
+    if(buffer_layout(&b, channelsLast, &w, &h, &c, &layout)) {
+        PyBuffer_Release(&b);
+        return NULL;
+    }
+    if(c != self->plan.c) {
+        PyBuffer_Release(&b);
+        PyErr_SetString(PyExc_ValueError, "Wrong number of channels");
+        return NULL;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    splinter_homography_layout(b.buf, layout, x0, y0, w, h, self->plan, H);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&b);
+    Py_RETURN_NONE;
+}
+
+/// eval(points, out): points float64 of shape (n,2), out float64 of shape
+/// (n,c), both C-contiguous
+static PyObject* Plan_eval(PlanObject* self, PyObject* args) {
+    PyObject *points, *out;
+    if(! PyArg_ParseTuple(args, "OO", &points, &out) || check_valid(self))
+        return NULL;
+    Py_buffer p, o;
+    if(PyObject_GetBuffer(points, &p, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT))
+        return NULL;
+    if(PyObject_GetBuffer(out, &o,
+                          PyBUF_C_CONTIGUOUS|PyBUF_FORMAT|PyBUF_WRITABLE)) {
+        PyBuffer_Release(&p);
+        return NULL;
+    }
+    Py_ssize_t n = p.len / (2*sizeof(double));
+    int ok = (p.format && p.format[strlen(p.format)-1] == 'd' &&
+              o.format && o.format[strlen(o.format)-1] == 'd' &&
+              p.len == (Py_ssize_t)(n*2*sizeof(double)) &&
+              o.len == (Py_ssize_t)(n*self->plan.c*sizeof(double)));
+    if(ok) {
+        Py_BEGIN_ALLOW_THREADS
+        splinter_batch(o.buf, p.buf, (int)n, self->plan);
+        Py_END_ALLOW_THREADS
+    } else
+        PyErr_SetString(PyExc_ValueError, "Expected float64 points (n,2) "
+                        "and out (n,channels), C-contiguous");
+    PyBuffer_Release(&o);
+    PyBuffer_Release(&p);
+    if(! ok)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+/// Dimensions of image: (width, height, channels)
+static PyObject* Plan_shape(PlanObject* self, void* closure) {
+    (void)closure;
+    if(check_valid(self))
+        return NULL;
+    int s = self->plan.shift;
+    return Py_BuildValue("(iii)", self->plan.w-2*s, self->plan.h-2*s,
+                         self->plan.c);
+}
+
+static PyMethodDef Plan_methods[] = {
+    {"warp", (PyCFunction)(void(*)(void))Plan_warp,
+     METH_VARARGS|METH_KEYWORDS,
+     "warp(H, out, x0=0, y0=0, channels_last=True)\n"
+     "Apply homography H (9 values) to image, output written in out, whose "
+     "top-left pixel is (x0,y0)."},
+    {"eval", (PyCFunction)Plan_eval, METH_VARARGS,
+     "eval(points, out)\nInterpolate at points (n,2), values written in "
+     "out (n,channels)."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef Plan_getset[] = {
+    {"shape", (getter)Plan_shape, NULL, "(width, height, channels)", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyTypeObject PlanType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "splinter.Plan",
+    .tp_doc = "Plan(image, order=11, boundary='hsymmetric', eps=1e-6, "
+              "larger=False, channels_last=True)\n"
+              "Prefiltered image for B-spline interpolation.",
+    .tp_basicsize = sizeof(PlanObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)Plan_init,
+    .tp_dealloc = (destructor)Plan_dealloc,
+    .tp_methods = Plan_methods,
+    .tp_getset = Plan_getset,
+};
+
+/// set_num_threads(n)
+static PyObject* set_num_threads(PyObject* self, PyObject* args) {
+    (void)self;
+    int n;
+    if(! PyArg_ParseTuple(args, "i", &n))
+        return NULL;
+    splinter_plan_with_nthreads(n);
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef module_methods[] = {
+    {"set_num_threads", set_num_threads, METH_VARARGS,
+     "set_num_threads(n)\nNumber of threads of plan creation and warp."},
+    {NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef splinter_module = {
+    PyModuleDef_HEAD_INIT, "splinter",
+    "B-spline interpolation of images (zero-copy buffers).",
+    -1, module_methods, NULL, NULL, NULL, NULL
+};
+
+/// Module initialization
+PyMODINIT_FUNC PyInit_splinter(void) {
+    if(PyType_Ready(&PlanType) < 0)
+        return NULL;
+    PyObject* m = PyModule_Create(&splinter_module);
+    if(! m)
+        return NULL;
+    Py_INCREF(&PlanType);
+    if(PyModule_AddObject(m, "Plan", (PyObject*)&PlanType) < 0) {
+        Py_DECREF(&PlanType);
+        Py_DECREF(m);
+        return NULL;
+    }
+    return m;
+}
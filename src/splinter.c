@@ -28,6 +28,10 @@
 #include <assert.h>
 #include <math.h>
 
+#ifndef M_PI_2
+#define M_PI_2 1.57079632679489661923
+#endif
+
 // ********************** boundary condition **********************************
 
 /// \brief Boundary handling function for constant extension
@@ -109,10 +113,8 @@ static int (*ExtensionMethod[4])(int, int) =
 /// The coefficient alpha must satisify |alpha| < 1 for stability.
 ///
 /// With respect to boundary handling, filtering is computed with relative
-/// accuracy eps for half-and whole-sample symmetric boundaries and it
-/// is exact for constant extension.  Note, however, that for constant extension
-/// the infinite grid result is not exactly constant beyond the boundaries
-/// (rather it decays to constant).
+/// accuracy eps for half-and whole-sample symmetric boundaries. Constant
+/// extension is handled by \ref expFilterConst.
 static void expFilter(double *data, int step, int n,
                       BoundaryExt boundary, double alpha, int n0) {
     double powAlpha=1, last=data[0];
@@ -125,9 +127,6 @@ static void expFilter(double *data, int step, int n,
     int i, iEnd=n0*step;
     // Causal init
     switch(boundary) {
-    case BOUNDARY_CONSTANT:
-        last /= 1-alpha;
-        break;
     case BOUNDARY_HSYMMETRIC:
         for(i=0; i<iEnd; i+=step) {
             powAlpha *= alpha;
@@ -160,10 +159,6 @@ static void expFilter(double *data, int step, int n,
 
     // Anti-causal init
     switch(boundary) {
-    case BOUNDARY_CONSTANT:
-        data[iEnd] = last = (alpha*(-data[iEnd] + (alpha - 1)*alpha*last))
-            /((alpha - 1)*(alpha*alpha - 1));
-        break;
     case BOUNDARY_HSYMMETRIC:
         data[iEnd] += alpha*last;
         last = data[iEnd] *= alpha/(alpha - 1);
@@ -183,6 +178,8 @@ static void expFilter(double *data, int step, int n,
         }
         data[iEnd] = last *= -alpha;
         break;
+    default: assert(0); // Should never go here
+        break;
     }
     // Anti-causal filter
     for(i=iEnd-step; i>=0; i-=step) {
@@ -191,33 +188,300 @@ static void expFilter(double *data, int step, int n,
     }
 }
 
+// ********************** image layout ****************************************
+
+/// \brief Layout of planar image of doubles: R...RG...GB...B
+splinter_layout_t splinter_layout_planar(int w, int h) {
+    splinter_layout_t l = {SPLINTER_FLOAT64, 1, w, (ptrdiff_t)w*h};
+    return l;
+}
+
+/// \brief Layout of interleaved image of doubles: RGBRGB...RGB
+splinter_layout_t splinter_layout_interleaved(int w, int c) {
+    splinter_layout_t l = {SPLINTER_FLOAT64, c, (ptrdiff_t)w*c, 1};
+    return l;
+}
+
+/// \brief Size in bytes of scalar type
+static size_t typeSize(SplinterType t) {
+    return (t == SPLINTER_FLOAT32)? sizeof(float): sizeof(double);
+}
+
+/// \brief Value at index \a i of buffer \a p of type \a t
+inline static double sampleAt(const void* p, SplinterType t, ptrdiff_t i) {
+    if(t == SPLINTER_FLOAT32)
+        return ((const float*)p)[i];
+    return ((const double*)p)[i];
+}
+
+// ********************** prefiltering tasks *********************************
+
+/// \brief Arguments of the parallel tasks of prefiltering
+typedef struct {
+    double* data; ///< image data (or larger domain)
+    const void* in; ///< channel of input image (copy and larger domain)
+    const splinter_layout_t* layout; ///< layout of input image
+    int w, h; ///< image dimensions
+    BoundaryExt boundary; ///< boundary extension
+    const prefilter_t* m; ///< poles and number of poles
+    const int* truncation; ///< truncation values in the initializations
+    const int* Lprecision; ///< larger domain extensions (larger domain only)
+    double* tail; ///< tails (constant extension in exact domain only)
+    int x0, y0; ///< origin of region in input image (larger domain only)
+    int wIn, hIn; ///< input image dimensions (larger domain only)
+} prefilter_args_t;
+
+/// \brief Exponential filters on columns [x0,x1) of the image
+static void prefilterColumns(void* args, int x0, int x1) {
+    const prefilter_args_t* a = args;
+    for(int x = x0; x < x1; x++)
+        for(int k = 0; k < a->m->nPoles; k++)
+            expFilter(a->data + x, a->w, a->h, a->boundary,
+                      a->m->poles[k], a->truncation[k]);
+}
+
+/// \brief Exponential filters and normalization on rows [y0,y1) of the image
+static void prefilterRows(void* args, int y0, int y1) {
+    const prefilter_args_t* a = args;
+    unsigned long long factor = a->m->normalization*a->m->normalization;
+    for(int y = y0; y < y1; y++) {
+        double* row = a->data + a->w*y;
+        for(int k = 0; k < a->m->nPoles; k++)
+            expFilter(row, 1, a->w, a->boundary,
+                      a->m->poles[k], a->truncation[k]);
+        // Normalization, twice because 2D
+        if(factor != 1)
+            for(int x = 0; x < a->w; x++)
+                row[x] *= factor;
+    }
+}
+
 /// \brief Apply a cascade of exponential filters to an image
-/// \details This is Algorithm 5 in the IPOL article.
+/// \details This is Algorithm 5 in the IPOL article. Columns, then rows, are
+/// distributed among threads.
 /// \param data the image data
 /// \param w,h image dimensions
 /// \param boundary the kind of boundary handling to use
 /// \param m structure with poles and number of poles
 /// \param truncation array of truncation values in the initializations
-static void prefiltering(double* data, int w, int h, BoundaryExt boundary,
-                         const prefilter_t* m, const int* truncation) {
-    int x, y, k;
+/// \param ctl interruption conditions (may be NULL)
+static SplinterStatus prefiltering(double* data, int w, int h,
+                                   BoundaryExt boundary, const prefilter_t* m,
+                                   const int* truncation,
+                                   const splinter_control_t* ctl) {
+    prefilter_args_t args = {.data=data, .w=w, .h=h, .boundary=boundary,
+                             .m=m, .truncation=truncation};
+    SplinterStatus status =
+        splinter_parallel_for_control(w, prefilterColumns, &args, ctl);
+    if(status == SPLINTER_OK)
+        status = splinter_parallel_for_control(h, prefilterRows, &args, ctl);
+    return status;
+}
+
+// ********************** prefiltering exact domain, constant extension *******
+
+/// \brief 1D in-place exponential filter for constant extension
+/// \details The signal beyond each end of \a data is represented in closed
+/// form: at distance m>=0 from the end sample, its value is
+/// \f[ t_0 + \sum_{j<k} t_{j+1} z_j^m, \f]
+/// with z_j the poles already applied. Both initializations are then exact
+/// sums of geometric series, without truncation, and the output tails keep the
+/// same form with the additional pole z_k.
+/// \param data pointer to data to be filtered
+/// \param step stride between successive elements of \a data
+/// \param n number of samples of \a data
+/// \param k index of the pole to apply
+/// \param z array of poles
+/// \param left,right tail coefficients before and after \a data (updated)
+static void expFilterConst(double *data, int step, int n, int k,
+                           const double* z, double* left, double* right) {
+    double alpha = z[k];
+    int i, j, iEnd = (n-1)*step;
+
+    // Causal init: sum of alpha^i data[-i] over the left tail
+    double last = left[0] /= 1-alpha;
+    for(j=0; j<k; j++)
+        last += left[j+1] /= 1-alpha*z[j];
+    data[0] = last;
+
+    // Causal filter
+    for(i=step; i<=iEnd; i+=step) {
+        data[i] += alpha*last;
+        last = data[i];
+    }
+
+    // Right tail after causal filter, the new mode is alpha
+    double sum = right[0] /= 1-alpha;
+    for(j=0; j<k; j++)
+        sum += right[j+1] *= z[j]/(z[j]-alpha);
+    right[k+1] = last - sum;
+
+    // Anti-causal init: -alpha times sum of alpha^i data[n-1+i]
+    right[0] *= -alpha/(1-alpha);
+    for(j=0; j<k; j++)
+        right[j+1] *= -alpha/(1-alpha*z[j]);
+    right[k+1] *= -alpha/(1-alpha*alpha);
+    last = 0;
+    for(j=0; j<=k+1; j++)
+        last += right[j];
+    data[iEnd] = last;
+
+    // Anti-causal filter
+    for(i=iEnd-step; i>=0; i-=step) {
+        data[i] = alpha*(last - data[i]);
+        last = data[i];
+    }
+
+    // Left tail after anti-causal filter, the new mode is alpha
+    sum = left[0] *= -alpha/(1-alpha);
+    for(j=0; j<k; j++)
+        sum += left[j+1] *= -alpha*z[j]/(z[j]-alpha);
+    left[k+1] = last - sum;
+}
+
+/// \brief Prefilter a 1D signal with constant extension
+/// \param data pointer to data to be filtered
+/// \param step stride between successive elements of \a data
+/// \param n number of samples of \a data
+/// \param m structure with poles and number of poles
+/// \param[out] left,right tail coefficients, arrays of size nPoles+1
+static void prefilterConst1D(double* data, int step, int n,
+                             const prefilter_t* m, double* left,double* right){
+    left[0] = data[0];
+    right[0] = data[(n-1)*step];
+    for(int k = 0; k < m->nPoles; k++)
+        expFilterConst(data, step, n, k, m->poles, left, right);
+}
+
+/// \brief Number of tail coefficients stored per channel
+static int tailSize(int w, int h, int nPoles) {
+    int p = nPoles+1;
+    return p*(2*w+2*h) + 4*p*p;
+}
+
+/// \brief Exponential filters on columns [x0,x1), storing top and bottom tails
+static void prefilterConstColumns(void* args, int x0, int x1) {
+    const prefilter_args_t* a = args;
+    int w = a->w, p = a->m->nPoles+1;
+    double *top=a->tail, *bottom=top+p*w;
+    double *l = malloc(2*p*sizeof*l), *r = l+p;
+    for(int x = x0; x < x1; x++) {
+        prefilterConst1D(a->data + x, w, a->h, a->m, l, r);
+        for(int q = 0; q < p; q++) {
+            top[q*w+x] = l[q];
+            bottom[q*w+x] = r[q];
+        }
+    }
+    free(l);
+}
+
+/// \brief Exponential filters on rows [y0,y1), storing left and right tails.
+/// Rows of the image are normalized, not the tails.
+static void prefilterConstRows(void* args, int y0, int y1) {
+    const prefilter_args_t* a = args;
+    int w = a->w, h = a->h, p = a->m->nPoles+1;
+    double *left=a->tail+2*p*w, *right=left+p*h;
+    double *l = malloc(2*p*sizeof*l), *r = l+p;
+    unsigned long long factor = a->m->normalization*a->m->normalization;
+    for(int y = y0; y < y1; y++) {
+        double* row = a->data + w*y;
+        prefilterConst1D(row, 1, w, a->m, l, r);
+        for(int q = 0; q < p; q++) {
+            left[q*h+y] = l[q];
+            right[q*h+y] = r[q];
+        }
+        if(factor != 1)
+            for(int x = 0; x < w; x++)
+                row[x] *= factor;
+    }
+    free(l);
+}
 
-    // Prefiltering of the columns
-    for(x = 0; x < w; x++)
-        for(k = 0; k < m->nPoles; k++)
-            expFilter(data + x, w, h, boundary, m->poles[k], truncation[k]);
+/// \brief Apply a cascade of exponential filters to an image, constant
+/// extension in the exact domain
+/// \details The coefficients beyond the image are not stored but represented
+/// by their tails in \a tail, so that no larger domain is required. The layout
+/// of \a tail, with p=nPoles+1, is: top[p][w], bottom[p][w], left[p][h],
+/// right[p][h], corners[4][p][p] (top-left, top-right, bottom-left,
+/// bottom-right).
+/// \param data the image data
+/// \param w,h image dimensions
+/// \param m structure with poles and number of poles
+/// \param[out] tail coefficients beyond the image, see \ref tailSize
+/// \param ctl interruption conditions (may be NULL)
+static SplinterStatus prefilteringConst(double* data, int w, int h,
+                                        const prefilter_t* m, double* tail,
+                                        const splinter_control_t* ctl) {
+    prefilter_args_t args = {.data=data, .w=w, .h=h,
+                             .boundary=BOUNDARY_CONSTANT, .m=m, .tail=tail};
+    SplinterStatus status =
+        splinter_parallel_for_control(w, prefilterConstColumns, &args, ctl);
+    if(status == SPLINTER_OK)
+        status = splinter_parallel_for_control(h, prefilterConstRows, &args,
+                                               ctl);
+    if(status != SPLINTER_OK)
+        return status;
 
-    // Prefiltering of the rows
-    for(y = 0; y < h; y++)
-        for(k = 0; k < m->nPoles; k++)
-            expFilter(data+w*y, 1, w, boundary, m->poles[k], truncation[k]);
+    // Prefiltering of the rows of the top and bottom tails, yielding corners
+    int p = m->nPoles+1;
+    double *top=tail, *bottom=top+p*w, *corner=bottom+p*(w+2*h);
+    for(int q = 0; q < p; q++) {
+        prefilterConst1D(top + q*w, 1, w, m, corner+q*p, corner+(p+q)*p);
+        prefilterConst1D(bottom + q*w, 1, w, m,
+                         corner+(2*p+q)*p, corner+(3*p+q)*p);
+    }
 
-    // Normalization, twice because 2D
+    // Normalization of tails, twice because 2D
     if(m->normalization != 1) {
         unsigned long long factor = m->normalization*m->normalization;
-        for(k = 0; k < w*h; k++)
-            data[k] *= factor;
+        for(int i = 0; i < tailSize(w, h, p-1); i++)
+            tail[i] *= factor;
     }
+    return SPLINTER_OK;
+}
+
+/// \brief Evaluate the closed form of a tail, \a zd being the powers of the
+/// poles at the distance from the end.
+static double evalTail(const double* t, int stride, const double* zd,
+                       int nPoles) {
+    double v = t[0];
+    for(int j = 0; j < nPoles; j++)
+        v += t[(j+1)*stride]*zd[j];
+    return v;
+}
+
+/// \brief Powers of the poles at the distance of \a i beyond [0,n-1]
+/// \return the distance, 0 if \a i is inside
+static int polePowers(double* zd, const double* z, int nPoles, int n, int i) {
+    int d = (i<0)? -i: (i>=n)? i-(n-1): 0;
+    for(int j = 0; d && j < nPoles; j++)
+        zd[j] = pow(z[j], d);
+    return d;
+}
+
+/// \brief Coefficient at (x,y), possibly outside the image (constant
+/// extension in the exact domain).
+/// \param data prefiltered channel
+/// \param tail tails of the channel, see \ref prefilteringConst
+/// \param zx,zy powers of poles at distance \a dx, \a dy (see
+/// \ref polePowers)
+static double coeffConst(const double* data, const double* tail,
+                         int w, int h, int nPoles, int x, int y,
+                         int dx, const double* zx, int dy, const double* zy) {
+    int p = nPoles+1;
+    const double *top=tail, *bottom=top+p*w, *left=bottom+p*w, *right=left+p*h;
+    const double *corner=right+p*h;
+    if(dx == 0 && dy == 0)
+        return data[x+w*y];
+    if(dx == 0)
+        return evalTail((y<0? top: bottom)+x, w, zy, nPoles);
+    if(dy == 0)
+        return evalTail((x<0? left: right)+y, h, zx, nPoles);
+    corner += ((y<0)? 0: 2*p*p) + ((x<0)? 0: p*p);
+    double v = evalTail(corner, 1, zx, nPoles);
+    for(int q = 1; q < p; q++)
+        v += evalTail(corner+q*p, 1, zx, nPoles) * zy[q-1];
+    return v;
 }
 
 /// \brief 1D in-place exp filter with a recursive filter pair (larger domain)
@@ -262,66 +526,141 @@ static void expFilterExt(double *data, int step, int n, double alpha, int n0) {
     }
 }
 
+/// \brief Copy rows [y0,y1) of the region of input into the larger domain,
+/// extended.
+static void extendRows(void* args, int y0, int y1) {
+    const prefilter_args_t* a = args;
+    int w = a->wIn, h = a->hIn, L2 = a->Lprecision[0], w2 = a->w+2*L2;
+    int (*Extension)(int, int) = ExtensionMethod[a->boundary];
+    SplinterType t = a->layout->type;
+    ptrdiff_t xStride = a->layout->xStride, yStride = a->layout->yStride;
+    for(int y=y0; y<y1; y++) {
+        int v = y-L2+a->y0, yIn = (0<=v && v<h)? v: Extension(h,v);
+        double* out = a->data + w2*y;
+        for(int x=0; x<w2; x++) {
+            int u = x-L2+a->x0, xIn = (0<=u && u<w)? u: Extension(w,u);
+            out[x] = sampleAt(a->in, t, xIn*xStride + yIn*yStride);
+        }
+    }
+}
+
+/// \brief Exponential filters on columns [x0,x1) of the larger domain
+static void prefilterExtColumns(void* args, int x0, int x1) {
+    const prefilter_args_t* a = args;
+    const int* Lprecision = a->Lprecision;
+    int L2 = Lprecision[0], w2 = a->w+2*L2, h2 = a->h+2*L2;
+    // L2-Lprecision[k] = sum_{i=0}^{k-1} truncation[i] is the length of values
+    // that are not used for computing the k-th application of exp filter
+    for(int x = x0; x < x1; x++)
+        for(int k = 0; k < a->m->nPoles; k++)
+            expFilterExt(a->data+x+(L2-Lprecision[k])*w2, w2,
+                         h2-2*(L2-Lprecision[k]),
+                         a->m->poles[k], a->truncation[k]);
+}
+
+/// \brief Exponential filters and normalization on rows L3+[i0,i1) of the
+/// larger domain
+static void prefilterExtRows(void* args, int i0, int i1) {
+    const prefilter_args_t* a = args;
+    const int* Lprecision = a->Lprecision;
+    int nPoles = a->m->nPoles;
+    int L2 = Lprecision[0], w2 = a->w+2*L2, L3 = L2-Lprecision[nPoles];
+    unsigned long long factor = a->m->normalization*a->m->normalization;
+    for(int y = L3+i0; y < L3+i1; y++) {
+        double* row = a->data + w2*y;
+        for(int k = 0; k < nPoles; k++)
+            expFilterExt(row + (L2-Lprecision[k]), 1,
+                         w2-2*(L2-Lprecision[k]),
+                         a->m->poles[k], a->truncation[k]);
+        // renormalization
+        if(factor != 1)
+            for(int x=L3; x < w2-L3; x++)
+                row[x] *= factor;
+    }
+}
+
 /// \brief Apply a cascade of exponential filters to an image (larger domain)
 /// \details This is Algorithm 4 in the IPOL article.
+/// \param prefilt the output, image in larger domain
 /// \param data the image data
-/// \param w,h image dimensions
+/// \param layout memory layout of \a data
+/// \param x0,y0 origin of the region to prefilter in the image
+/// \param w,h region dimensions
+/// \param wIn,hIn image dimensions
 /// \param boundary the kind of boundary handling to use
 /// \param m structure with poles and number of poles
 /// \param truncation array of truncation values in the initializations
 /// \param Lprecision array of larger domain extensions
-static void prefilteringExt(double* prefilt, const double* data,int w,int h,
-                            BoundaryExt boundary,
-                            const prefilter_t* m, const int* truncation,
-                            const int* Lprecision) {
-    int k, x, y;
-    int nPoles = m->nPoles;
-    // extended domain sizes
+/// \param ctl interruption conditions (may be NULL)
+static SplinterStatus prefilteringExt(double* prefilt, const void* data,
+                                      const splinter_layout_t* layout,
+                                      int x0, int y0, int w, int h,
+                                      int wIn, int hIn, BoundaryExt boundary,
+                                      const prefilter_t* m,
+                                      const int* truncation,
+                                      const int* Lprecision,
+                                      const splinter_control_t* ctl) {
+    prefilter_args_t args = {prefilt, data, layout, w, h, boundary, m,
+                             truncation, Lprecision, NULL, x0, y0, wIn, hIn};
     int L2 = Lprecision[0];
-    int w2 = w+2*L2;
-    int h2 = h+2*L2;
 
     // extend the input data
-    int (*Extension)(int, int) = ExtensionMethod[boundary];
-    for(y=0; y<h2; y++) {
-        int y0 = ((0<=y-L2 && y-L2<h)? y-L2: Extension(h,y-L2));
-        int offset0 = w*y0;
-        int offset = w2*y;
-        for(x=0; x<w2; x++){
-            int x0 = ((0<=x-L2 && x-L2<w)? x-L2: Extension(w,x-L2));
-            prefilt[x+offset] = data[x0+offset0];
-      }
-    }
+    SplinterStatus status =
+        splinter_parallel_for_control(h+2*L2, extendRows, &args, ctl);
 
-    // L2-Lprecision[k] = sum_{i=0}^{k-1} truncation[i] is the length of values
-    // that are not used for computing the k-th application of exp filter
-    if(nPoles > 0) { // security check
+    if(m->nPoles > 0 && status == SPLINTER_OK) { // security check
         // prefiltering of the columns
-        for(x = 0; x < w2; x++)
-            for(k = 0; k < nPoles; k++)
-                expFilterExt(prefilt+x+(L2-Lprecision[k])*w2, w2,
-                             h2-2*(L2-Lprecision[k]),
-                             m->poles[k], truncation[k]);
-
+        status = splinter_parallel_for_control(w+2*L2, prefilterExtColumns,
+                                               &args, ctl);
         // prefiltering of the rows, needs to be computed only from
         // L3 = sum(truncation[i]) to h2-L3
-        int L3 = L2-Lprecision[nPoles];
-        for(y=L3; y < h2-L3; y++)
-            for(k = 0; k < nPoles; k++)
-                expFilterExt(prefilt + w2*y + (L2-Lprecision[k]), 1,
-                             w2-2*(L2-Lprecision[k]),
-                             m->poles[k], truncation[k]);
+        int L3 = L2-Lprecision[m->nPoles];
+        if(status == SPLINTER_OK)
+            status = splinter_parallel_for_control(h+2*L2-2*L3,
+                                                   prefilterExtRows,
+                                                   &args, ctl);
+    }
+    return status;
+}
 
-        // renormalization
-        if(m->normalization != 1) {
-            unsigned long long factor = m->normalization*m->normalization;
-            for(y=L3; y < h2-L3; y++)
-                for(x=L3; x < w2-L3; x++)
-                    prefilt[x+w2*y] *= factor;
-        }
+/// \brief Copy rows [y0,y1) of a channel of the input image.
+static void copyRows(void* args, int y0, int y1) {
+    const prefilter_args_t* a = args;
+    SplinterType t = a->layout->type;
+    ptrdiff_t xStride = a->layout->xStride, yStride = a->layout->yStride;
+    for(int y=y0; y<y1; y++) {
+        double* out = a->data + a->w*y;
+        for(int x=0; x<a->w; x++)
+            out[x] = sampleAt(a->in, t, x*xStride + y*yStride);
     }
 }
 
+/// Parameters of prefiltering kept by the plan, see \ref splinter_replan
+struct splinter_setup_s {
+    prefilter_t prefilter; ///< poles of the prefilter
+    int* truncation; ///< truncation indices of the poles
+    int* Lprecision; ///< extensions of the larger domain (NULL if exact)
+    BoundaryExt e; ///< boundary extension
+    int owner; ///< whether the coefficient arrays are freed with the plan
+    int x0, y0; ///< origin of the region of the plan in the input image
+    int wIn, hIn; ///< dimensions of the input image
+    double* tiles; ///< coefficients in tiles with halo (NULL if row-major)
+    int* tileRank; ///< rank in Morton order of each tile of the grid
+    int tile, side; ///< side of tiles, without and with halo
+    int tx0, ty0; ///< first kernel position of tile grid
+    int ntx, nty; ///< number of tiles of grid
+    unsigned long generation; ///< number of recomputations of coefficients
+    int readOnly; ///< coefficients shared with other readers: no replan
+};
+
+static splinter_plan_t createPlan(const void* in, splinter_layout_t layout,
+                                  int w, int h, int c, int order,
+                                  BoundaryExt e, double eps, int larger,
+                                  const int* region,
+                                  const splinter_control_t* ctl,
+                                  SplinterStatus* status, double* buffer,
+                                  double* tailBuffer, int owner);
+
 /// \brief Create a plan for spline interpolation.
 /// \details This performs the prefiltering of the image and stores the result.
 /// After usage by calls to function \ref splinter, the plan must be disposed of
@@ -346,62 +685,470 @@ static void prefilteringExt(double* prefilt, const double* data,int w,int h,
 
 splinter_plan_t splinter_plan(const double* in, int w, int h, int c,
                               int order, BoundaryExt e, double eps, int larger){
-    splinter_plan_t plan = {.w=w, .h=h, .c=c, .shift=0};
-    prefilter_t prefilter;
-    plan.bspline = malloc(sizeof(Bspline));
-    get_bspline(order, &prefilter, plan.bspline);
+    return splinter_plan_layout(in, splinter_layout_planar(w,h), w, h, c,
+                                order, e, eps, larger);
+}
 
-    // compute the truncation values
+/// \brief Create a plan for spline interpolation from an image of any layout.
+/// \details Same as \ref splinter_plan, but the input image is read according
+/// to \a layout, e.g., interleaved channels or float values, without
+/// intermediate copy.
+splinter_plan_t splinter_plan_layout(const void* in, splinter_layout_t layout,
+                                     int w, int h, int c, int order,
+                                     BoundaryExt e, double eps, int larger) {
+    return splinter_plan_control(in, layout, w, h, c, order, e, eps, larger,
+                                 NULL, NULL);
+}
+
+/// \brief Create a plan for spline interpolation, which can be interrupted.
+/// \details Same as \ref splinter_plan_layout, but the computation stops
+/// early when a condition of \a ctl is met. The returned plan is then empty
+/// (its member prefilt is NULL) and needs no disposal.
+/// \param ctl interruption conditions (may be NULL)
+/// \param[out] status SPLINTER_OK if the plan is complete (may be NULL)
+splinter_plan_t splinter_plan_control(const void* in, splinter_layout_t layout,
+                                      int w, int h, int c, int order,
+                                      BoundaryExt e, double eps, int larger,
+                                      const splinter_control_t* ctl,
+                                      SplinterStatus* status) {
+    return createPlan(in, layout, w, h, c, order, e, eps, larger, NULL, ctl,
+                      status, NULL, NULL, 1);
+}
+
+/// \brief Create a plan, prefiltering in place the image \a in.
+/// \details Same as \ref splinter_plan, but the plan takes ownership of \a in,
+/// which must have been allocated by malloc: its coefficients are computed
+/// in this buffer, avoiding a copy of the image. The buffer is freed by
+/// \ref splinter_destroy_plan. Since the larger domain needs a larger buffer,
+/// if \a larger is set the buffer is freed once the plan is created.
+splinter_plan_t splinter_plan_inplace(double* in, int w, int h, int c,
+                                      int order, BoundaryExt e, double eps,
+                                      int larger) {
+    splinter_plan_t plan;
+    if(larger) {
+        plan = splinter_plan(in, w, h, c, order, e, eps, larger);
+        free(in);
+    } else
+        plan = createPlan(in, splinter_layout_planar(w,h), w, h, c, order, e,
+                          eps, larger, NULL, NULL, NULL, in, NULL, 1);
+    return plan;
+}
+
+/// \brief Create a plan for a rectangular region of the image only.
+/// \details The coefficients are computed in the larger domain around the
+/// region, whose pixels beyond the region are the actual neighbors in the
+/// image (or its extension). The plan must be evaluated at coordinates
+/// relative to the top-left pixel of the region, and gives the same values as
+/// a plan of the whole image in the larger domain (beyond the image, if
+/// extrapolation is enabled, as a plan in the exact domain, up to precision
+/// \a eps). Its memory is that of a
+/// plan in the larger domain of size (w,h) of the region, see
+/// \ref splinter_plan_bytes.
+/// \param region top-left pixel and dimensions (x0,y0,w,h) of the region.
+/// Unless extrapolation is enabled, it is reduced to its intersection with the
+/// image, or to a single pixel of the image if they do not intersect, since
+/// outside the image the interpolation value is 0.
+/// \param budget maximum memory of the plan in bytes (SIZE_MAX for no limit)
+/// \return the plan, or an empty plan (NULL \c prefilt) if the budget is
+/// exceeded.
+splinter_plan_t splinter_plan_region(const void* in, splinter_layout_t layout,
+                                     int w, int h, int c, int order,
+                                     BoundaryExt e, double eps, int region[4],
+                                     size_t budget) {
+#ifndef EXTRAPOLATE
+    int dims[2] = {w, h};
+    for(int i=0; i<2; i++) {
+        int a = region[i], b = region[i]+region[i+2];
+        if(a < 0) a = 0;
+        if(b > dims[i]) b = dims[i];
+        if(a >= b) {
+            a = (a < dims[i])? a: dims[i]-1;
+            b = a+1;
+        }
+        region[i] = a;
+        region[i+2] = b-a;
+    }
+#endif
+    if(splinter_plan_bytes(region[2], region[3], c, order, e, eps, 1) > budget){
+        splinter_plan_t empty = {.prefilt=NULL};
+        return empty;
+    }
+    return createPlan(in, layout, w, h, c, order, e, eps, 1, region, NULL,
+                      NULL, NULL, NULL, 1);
+}
+
+/// \brief Sizes of a plan: numbers of coefficients in \a nPrefilt and
+/// \a nTail, and memory of the other allocations as return value.
+static size_t planSizes(int w, int h, int c, int order,
+                        BoundaryExt e, double eps, int larger,
+                        size_t* nPrefilt, size_t* nTail) {
+    prefilter_t prefilter;
+    Bspline bspline;
+    get_bspline(order, &prefilter, &bspline);
     int tn = prefilter.nPoles;
     int* truncation = malloc(tn*sizeof*truncation);
     if(tn > 0)
         compute_truncation(truncation, prefilter.poles, tn, eps);
-    int* Lprecision=NULL;
+
+    size_t bytes = sizeof(struct splinter_setup_s) + sizeof(Bspline) +
+        tn*sizeof(int);
+    if(order > MAX_TABULATED_ORDER) {
+        bytes += tn*sizeof(double) +
+            ((order+1)*bspline.tn+(int)floor(bspline.radius)+1)*sizeof(double);
+        free(prefilter.poles);
+        free(bspline.C);
+    }
+    size_t wp = w, hp = h;
+    if(larger) {
+        int shift = tn;
+        for(int i=0; i<tn; i++)
+            shift += truncation[i];
+        wp += 2*shift;
+        hp += 2*shift;
+        bytes += (tn+1)*sizeof(int);
+    }
+    *nPrefilt = wp*hp*c;
+    *nTail = 0;
+    if(! larger && e == BOUNDARY_CONSTANT && tn > 0)
+        *nTail = tn+(size_t)c*tailSize(w,h,tn);
+    free(truncation);
+    return bytes;
+}
+
+/// \brief Memory allocated by a plan, in bytes.
+/// \details The parameters are those of \ref splinter_plan. The result is
+/// exact, including the larger domain, which depends on the truncation
+/// indices at precision \a eps. The temporary buffers of prefiltering are
+/// negligible in comparison: a few values per thread.
+size_t splinter_plan_bytes(int w, int h, int c, int order,
+                           BoundaryExt e, double eps, int larger) {
+    size_t nPrefilt, nTail;
+    size_t bytes = planSizes(w, h, c, order, e, eps, larger, &nPrefilt,&nTail);
+    return bytes + (nPrefilt+nTail)*sizeof(double);
+}
+
+/// \brief Numbers of values of the coefficient arrays of a plan, \c prefilt
+/// and \c tail, see \ref splinter_plan_wrap.
+void splinter_plan_sizes(int w, int h, int c, int order,
+                         BoundaryExt e, double eps, int larger,
+                         size_t* nPrefilt, size_t* nTail) {
+    planSizes(w, h, c, order, e, eps, larger, nPrefilt, nTail);
+}
+
+/// \brief Create a plan whose coefficients are stored in arrays provided by
+/// the caller, e.g., in shared memory.
+/// \details The parameters are those of \ref splinter_plan_layout. The arrays
+/// are not freed by \ref splinter_destroy_plan.
+/// \param prefilt,tail arrays of sizes given by \ref splinter_plan_sizes
+/// (\a tail may be NULL if its size is 0).
+/// \param in the input image, or NULL if the arrays already hold the
+/// coefficients of a plan with the same parameters. They are then only read.
+splinter_plan_t splinter_plan_wrap(double* prefilt, double* tail,
+                                   const void* in, splinter_layout_t layout,
+                                   int w, int h, int c, int order,
+                                   BoundaryExt e, double eps, int larger) {
+    return createPlan(in, layout, w, h, c, order, e, eps, larger, NULL, NULL,
+                      NULL, prefilt, tail, 0);
+}
+
+/// \brief Compute the coefficients of the plan from image \a in.
+/// \details All buffers are already allocated. If \a in is the coefficient
+/// array of the plan, it holds the image in planar form and is not copied.
+static SplinterStatus prefilterPlan(splinter_plan_t* plan, const void* in,
+                                    splinter_layout_t layout,
+                                    const splinter_control_t* ctl) {
+    const struct splinter_setup_s* s = plan->setup;
+    int w = plan->w-2*plan->shift, h = plan->h-2*plan->shift, c = plan->c;
+    int tn = s->prefilter.nPoles;
+    SplinterStatus st = SPLINTER_OK;
+    int planar = (layout.type == SPLINTER_FLOAT64 && layout.xStride == 1 &&
+                  layout.yStride == w && (c == 1 || layout.cStride == w*h));
+    int copy = (! s->Lprecision && in != plan->prefilt);
+    if(copy && planar)
+        memcpy(plan->prefilt, in, w*h*c*sizeof(double));
+    else if(copy)
+        for(int l=0; l<c && st==SPLINTER_OK; l++) {
+            prefilter_args_t args = {.data=plan->prefilt+l*w*h,
+                                     .in=(const char*)in +
+                                     l*layout.cStride*typeSize(layout.type),
+                                     .layout=&layout, .w=w, .h=h,
+                                     .boundary=s->e};
+            st = splinter_parallel_for_control(h, copyRows, &args, ctl);
+        }
+    for(int l=0; l<c && st==SPLINTER_OK; l++) {
+        if(s->Lprecision)
+            st = prefilteringExt(plan->prefilt+l*plan->w*plan->h,
+                                 (const char*)in +
+                                 l*layout.cStride*typeSize(layout.type),
+                                 &layout, s->x0, s->y0, w, h, s->wIn, s->hIn,
+                                 s->e, &s->prefilter, s->truncation,
+                                 s->Lprecision, ctl);
+        else if(plan->tail)
+            st = prefilteringConst(plan->prefilt+l*w*h, w, h, &s->prefilter,
+                                   plan->tail+tn+l*tailSize(w,h,tn), ctl);
+        else
+            st = prefiltering(plan->prefilt+l*w*h, w, h, s->e, &s->prefilter,
+                              s->truncation, ctl);
+    }
+    return st;
+}
+
+/// \brief Create a plan, see \ref splinter_plan_control.
+/// \details If \a buffer (and \a tailBuffer) are not NULL, they are used for
+/// the coefficients. The coefficient arrays are freed with the plan if
+/// \a owner is set. If \a buffer is \a in, it holds the image in planar
+/// form (\a larger must be 0). If \a in is NULL, the coefficients are
+/// already computed in the buffers. If \a region is not NULL, the plan
+/// covers only this rectangle (x0,y0,w,h) of the image, in the larger domain.
+static splinter_plan_t createPlan(const void* in, splinter_layout_t layout,
+                                  int w, int h, int c, int order,
+                                  BoundaryExt e, double eps, int larger,
+                                  const int* region,
+                                  const splinter_control_t* ctl,
+                                  SplinterStatus* status, double* buffer,
+                                  double* tailBuffer, int owner) {
+    splinter_plan_t plan = {.w=w, .h=h, .c=c, .shift=0};
+    struct splinter_setup_s* s = malloc(sizeof*s);
+    plan.setup = s;
+    plan.bspline = malloc(sizeof(Bspline));
+    get_bspline(order, &s->prefilter, plan.bspline);
+    s->e = e;
+    s->owner = owner;
+    s->x0 = s->y0 = 0;
+    s->tiles = NULL;
+    s->tileRank = NULL;
+    s->generation = 0;
+    s->readOnly = 0;
+    s->wIn = w;
+    s->hIn = h;
+    if(region) {
+        s->x0 = region[0];
+        s->y0 = region[1];
+        w = plan.w = region[2];
+        h = plan.h = region[3];
+        larger = 1;
+    }
+
+    // compute the truncation values
+    int tn = s->prefilter.nPoles;
+    s->truncation = malloc(tn*sizeof*s->truncation);
+    if(tn > 0)
+        compute_truncation(s->truncation, s->prefilter.poles, tn, eps);
+    s->Lprecision = NULL;
 
     if(larger) {
-        Lprecision = malloc((tn+1)*sizeof*Lprecision);
-        Lprecision[tn] = tn;
+        s->Lprecision = malloc((tn+1)*sizeof*s->Lprecision);
+        s->Lprecision[tn] = tn;
         for(int i=tn-1; i>=0; i--)
-            Lprecision[i] = Lprecision[i+1] + truncation[i];
-        plan.shift = Lprecision[0];
+            s->Lprecision[i] = s->Lprecision[i+1] + s->truncation[i];
+        plan.shift = s->Lprecision[0];
         plan.w += 2*plan.shift;
         plan.h += 2*plan.shift;
     }
 
-    plan.prefilt = malloc(plan.w*plan.h*c*sizeof*plan.prefilt);
-    if(! larger)
-        memcpy(plan.prefilt, in, w*h*c*sizeof(double));
-    for(int l=0; l<c; l++) {
-        if(larger)
-            prefilteringExt(plan.prefilt+l*plan.w*plan.h, in+l*w*h, w, h,
-                            e, &prefilter, truncation, Lprecision);
-        else
-            prefiltering(plan.prefilt+l*plan.w*plan.h, w, h,
-                         e, &prefilter, truncation);
+    plan.prefilt = buffer;
+    if(! buffer)
+        plan.prefilt = malloc(plan.w*plan.h*c*sizeof*plan.prefilt);
+    if(! larger && e == BOUNDARY_CONSTANT && tn > 0) { // poles, then channels
+        plan.tail = tailBuffer;
+        if(! plan.tail)
+            plan.tail = malloc((tn+c*tailSize(w,h,tn))*sizeof*plan.tail);
+        if(in)
+            memcpy(plan.tail, s->prefilter.poles, tn*sizeof*plan.tail);
     }
-    if(order > MAX_TABULATED_ORDER)
-        free(prefilter.poles);
-
     plan.ext = ExtensionMethod[e];
-    // B-spline of order 0 does not vanish at its support bounds
-    int kWidth = (order==0)? 2: order+1;
-    plan.xBuf = malloc(kWidth*sizeof*plan.xBuf);
-    plan.yBuf = malloc(kWidth*sizeof*plan.yBuf);
 
-    free(Lprecision);
-    free(truncation);
+    SplinterStatus st = SPLINTER_OK;
+    if(in)
+        st = prefilterPlan(&plan, in, layout, ctl);
+    if(st != SPLINTER_OK) {
+        splinter_destroy_plan(plan);
+        splinter_plan_t empty = {.prefilt=NULL};
+        plan = empty;
+    }
+    if(status)
+        *status = st;
     return plan;
 }
 
+// ********************** tiled coefficients *********************************
+
+/// \brief Number of taps of the kernel in each direction
+static int kernelWidth(splinter_plan_t plan) {
+    return (plan.bspline->order==0)? 2: plan.bspline->order+1;
+}
+
+/// \brief Index of coefficient \a i along a dimension of size \a n, as
+/// resolved by \ref splinter
+static int tapIndex(splinter_plan_t plan, int n, int i) {
+    int shift = plan.shift;
+    int shift2 = (shift-plan.bspline->tn>0)? shift-plan.bspline->tn: 0;
+    return (shift2<=i && i<n-shift2)? i: plan.ext(n-2*shift, i-shift)+shift;
+}
+
+/// \brief Bits of \a v interleaved with zeros
+static unsigned long long spreadBits(unsigned v) {
+    unsigned long long x = v;
+    x = (x | x<<16) & 0x0000FFFF0000FFFFull;
+    x = (x | x<<8) & 0x00FF00FF00FF00FFull;
+    x = (x | x<<4) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | x<<2) & 0x3333333333333333ull;
+    x = (x | x<<1) & 0x5555555555555555ull;
+    return x;
+}
+
+/// \brief Tile of grid with its Morton code
+typedef struct {
+    unsigned long long code; ///< Morton code
+    int index; ///< index of tile in row order of grid
+} morton_t;
+
+/// \brief Comparison of Morton codes for qsort
+static int compareMorton(const void* a, const void* b) {
+    unsigned long long u = ((const morton_t*)a)->code;
+    unsigned long long v = ((const morton_t*)b)->code;
+    return (u>v) - (u<v);
+}
+
+/// \brief Copy tiles [t0,t1), in row order of the grid, of the coefficients
+static void fillTileRange(void* args, int t0, int t1) {
+    const splinter_plan_t* plan = args;
+    const struct splinter_setup_s* s = plan->setup;
+    int side = s->side, c = plan->c;
+    for(int t=t0; t<t1; t++) {
+        int X0 = s->tx0 + (t%s->ntx)*s->tile, Y0 = s->ty0 + (t/s->ntx)*s->tile;
+        double* tile = s->tiles + (size_t)s->tileRank[t]*c*side*side;
+        for(int y=0; y<side; y++) {
+            int iY = tapIndex(*plan, plan->h, Y0+y);
+            for(int l=0; l<c; l++) {
+                const double* row = plan->prefilt +
+                    ((ptrdiff_t)l*plan->h + iY)*plan->w;
+                double* dst = tile + ((ptrdiff_t)l*side + y)*side;
+                for(int x=0; x<side; x++)
+                    dst[x] = row[tapIndex(*plan, plan->w, X0+x)];
+            }
+        }
+    }
+}
+
+/// \brief Copy the coefficients to the tiles
+static void fillTiles(splinter_plan_t plan) {
+    const struct splinter_setup_s* s = plan.setup;
+    splinter_parallel_for(s->ntx*s->nty, fillTileRange, &plan);
+}
+
+/// \brief Store a copy of the coefficients in tiles, for cache locality.
+/// \details The positions of the kernel are cut in tiles of \a tile x
+/// \a tile. Each tile stores, for all channels, the coefficients reached
+/// by the kernel at its positions: a square of side tile+order (halo
+/// included), boundary extension resolved. Tiles are stored in Morton order
+/// (Z-order) of the grid, so that neighbor tiles are close in memory in both
+/// directions. Then each interpolation by \ref splinter reads a contiguous
+/// block instead of order+1 rows far apart, which helps rotated and
+/// perspective warps. The result is identical. Memory is multiplied by
+/// about (1+order/tile)^2; \ref splinter_replan updates the tiles.
+/// \param tile side of tiles, typically 8 or 16. If 0, the tiles are freed.
+void splinter_plan_tiled(splinter_plan_t plan, int tile) {
+    struct splinter_setup_s* s = plan.setup;
+    free(s->tiles);
+    free(s->tileRank);
+    s->tiles = NULL;
+    s->tileRank = NULL;
+    if(tile <= 0)
+        return;
+    int kWidth = kernelWidth(plan);
+    s->tile = tile;
+    s->side = tile + kWidth-1;
+    s->tx0 = s->ty0 = -kWidth; // Kernel positions start at least there
+    s->ntx = (plan.w + kWidth + tile-1) / tile;
+    s->nty = (plan.h + kWidth + tile-1) / tile;
+    int n = s->ntx*s->nty;
+    morton_t* m = malloc(n*sizeof*m);
+    for(int t=0; t<n; t++) {
+        m[t].code = spreadBits(t%s->ntx) | spreadBits(t/s->ntx)<<1;
+        m[t].index = t;
+    }
+    qsort(m, n, sizeof*m, compareMorton);
+    s->tileRank = malloc(n*sizeof*s->tileRank);
+    for(int r=0; r<n; r++)
+        s->tileRank[m[r].index] = r;
+    free(m);
+    s->tiles = malloc((size_t)n*plan.c*s->side*s->side*sizeof*s->tiles);
+    fillTiles(plan);
+}
+
+/// \brief Recompute the coefficients of a plan from a new image.
+/// \details The image must have the dimensions and number of channels of the
+/// one the plan was created with (the whole image for a plan of a region);
+/// this cannot be checked. The kernel, truncation indices and buffers of the
+/// plan are reused, so that a sequence of images of same size (video frames,
+/// e.g.) is processed without any allocation. The result is identical to
+/// destroying the plan and creating a new one with the same parameters.
+/// Nothing is done if the plan is read-only, see \ref splinter_plan_readonly.
+/// \param plan a plan created by \ref splinter_plan or its variants.
+/// \param in the input image, in planar form.
+void splinter_replan(splinter_plan_t* plan, const double* in) {
+    int w = plan->w-2*plan->shift, h = plan->h-2*plan->shift;
+    splinter_replan_control(plan, in, splinter_layout_planar(w,h), NULL);
+}
+
+/// \brief Recompute the coefficients of a plan from a new image of arbitrary
+/// layout, see \ref splinter_replan and \ref splinter_plan_control.
+/// \details \a layout must address an image of the dimensions and number of
+/// channels of the plan's, see \ref splinter_replan. If interrupted, the
+/// coefficients are partly computed and the plan must be recomputed before
+/// use (or destroyed). The generation of the plan is incremented, see
+/// \ref splinter_plan_generation.
+/// \return SPLINTER_OK if the coefficients are complete, SPLINTER_INVALID
+/// without any change if the plan is read-only, see
+/// \ref splinter_plan_readonly.
+SplinterStatus splinter_replan_control(splinter_plan_t* plan, const void* in,
+                                       splinter_layout_t layout,
+                                       const splinter_control_t* ctl) {
+    if(plan->setup->readOnly)
+        return SPLINTER_INVALID;
+    ++plan->setup->generation;
+    SplinterStatus st = prefilterPlan(plan, in, layout, ctl);
+    if(st == SPLINTER_OK && plan->setup->tiles)
+        fillTiles(*plan);
+    return st;
+}
+
+/// \brief Forbid the recomputation of the coefficients of \a plan, e.g.,
+/// when they are read by other processes or mapped read-only.
+/// \details \ref splinter_replan_control then returns SPLINTER_INVALID, and
+/// \ref splinter_replan does nothing.
+void splinter_plan_readonly(splinter_plan_t plan) {
+    plan.setup->readOnly = 1;
+}
+
+/// \brief Number of recomputations of the coefficients of \a plan by
+/// \ref splinter_replan_control.
+/// \details Results derived from the coefficients, such as cached tiles, are
+/// valid only for the same coefficient array and generation.
+unsigned long splinter_plan_generation(splinter_plan_t plan) {
+    return plan.setup? plan.setup->generation: 0;
+}
+
 /// \brief Dispose of a plan created with \ref splinter_plan.
 /// \details Must be called when a plan is not used anymore.
 void splinter_destroy_plan(splinter_plan_t plan) {
-    if(plan.bspline->order > MAX_TABULATED_ORDER)
+    if(! plan.bspline) // Empty plan
+        return;
+    if(plan.bspline->order > MAX_TABULATED_ORDER) {
         free(plan.bspline->C);
+        free(plan.setup->prefilter.poles);
+    }
+    free(plan.setup->truncation);
+    free(plan.setup->Lprecision);
+    free(plan.setup->tiles);
+    free(plan.setup->tileRank);
+    if(plan.setup->owner) {
+        free(plan.prefilt);
+        free(plan.tail);
+    }
+    free(plan.setup);
     free(plan.bspline);
-    free(plan.prefilt);
-    free(plan.xBuf);
-    free(plan.yBuf);
 }
 
 /// \brief Perform spline interpolation at coordinates (x,y).
@@ -415,7 +1162,8 @@ void splinter_destroy_plan(splinter_plan_t plan) {
 /// specified at creation of the plan.
 /// \param x,y coordinates of pixel.
 /// \param plan the plan create with \ref splinter_plan.
-/// \details This is Algorithm 7 in the IPOL article.
+/// \details This is Algorithm 7 in the IPOL article. The plan is not
+/// modified, so that concurrent calls from several threads are allowed.
 void splinter(double* out, double x, double y, splinter_plan_t plan) {
     double (*betan)(double, const Bspline*) = plan.bspline->eval;
     double radius = plan.bspline->radius;
@@ -437,10 +1185,56 @@ void splinter(double* out, double x, double y, splinter_plan_t plan) {
 #endif
     // Evaluate the kernel
     int x0 = ceil(x-radius), y0 = ceil(y-radius);
+    double xBuf[kWidth], yBuf[kWidth];
     for(int k = 0; k < kWidth; k++)
-        plan.xBuf[k] = betan(x-(x0+k), plan.bspline);
+        xBuf[k] = betan(x-(x0+k), plan.bspline);
     for(int k = 0; k < kWidth; k++)
-        plan.yBuf[k] = betan(y-(y0+k), plan.bspline);
+        yBuf[k] = betan(y-(y0+k), plan.bspline);
+
+    // Constant extension in exact domain: coefficients beyond the image are
+    // given by their tails
+    if(plan.tail && (x0<0 || y0<0 || x0+kWidth>plan.w || y0+kWidth>plan.h)) {
+        int tn = plan.bspline->tn, size = tailSize(plan.w, plan.h, tn);
+        double zx[kWidth*tn], zy[kWidth*tn];
+        int dx[kWidth], dy[kWidth];
+        for(int k=0; k<kWidth; k++) {
+            dx[k] = polePowers(zx+k*tn, plan.tail, tn, plan.w, x0+k);
+            dy[k] = polePowers(zy+k*tn, plan.tail, tn, plan.h, y0+k);
+        }
+        for(int c=0; c<plan.c; c++) {
+            const double* data = plan.prefilt + c*plan.w*plan.h;
+            const double* tail = plan.tail + tn + c*size;
+            for(int l=0; l<kWidth; l++) {
+                double s=0;
+                for(int k=0; k<kWidth; k++)
+                    s += xBuf[k] * coeffConst(data, tail, plan.w, plan.h,
+                                                   tn, x0+k, y0+l,
+                                                   dx[k], zx+k*tn,
+                                                   dy[l], zy+l*tn);
+                out[c] += s*yBuf[l];
+            }
+        }
+        return;
+    }
+
+    // Tiled coefficients: the kernel reads a block of its tile
+    const struct splinter_setup_s* s = plan.setup;
+    if(s && s->tiles) {
+        int u = x0-s->tx0, v = y0-s->ty0, T = s->tile, side = s->side;
+        if(0<=u && u<s->ntx*T && 0<=v && v<s->nty*T) {
+            const double* row = s->tiles + (v%T)*side + u%T +
+                (size_t)s->tileRank[(v/T)*s->ntx + u/T]*plan.c*side*side;
+            for(int l=0; l<kWidth; l++, row+=side)
+                for(int c=0; c<plan.c; c++) {
+                    const double* r = row + (ptrdiff_t)c*side*side;
+                    double sum=0;
+                    for(int k=0; k<kWidth; k++)
+                        sum += r[k]*xBuf[k];
+                    out[c] += sum*yBuf[l];
+                }
+            return;
+        }
+    }
 
     // Compute the interpolated value at (x,y)
     for(int l=0; l<kWidth; l++) {
@@ -453,10 +1247,416 @@ void splinter(double* out, double x, double y, splinter_plan_t plan) {
             for(int k=0; k<kWidth; k++) {
                 int iX = (shift2<=x0+k && x0+k<plan.w-shift2)?
                     x0+k: plan.ext(plan.w-2*shift, x0+k-shift)+shift;
-                s += plan.prefilt[iX+rowOffset]*plan.xBuf[k];
+                s += plan.prefilt[iX+rowOffset]*xBuf[k];
             }
-            out[c] += s*plan.yBuf[l];
+            out[c] += s*yBuf[l];
             rowOffset += plan.w*plan.h;
         }
     }
 }
+
+/// \brief Arguments of parallel batch interpolation
+typedef struct {
+    double* out; ///< output values
+    const double* xy; ///< coordinates
+    splinter_plan_t plan; ///< interpolation plan
+} batch_args_t;
+
+/// \brief Interpolation at points [i0,i1)
+static void batchRange(void* args, int i0, int i1) {
+    const batch_args_t* a = args;
+    for(int i=i0; i<i1; i++)
+        splinter(a->out + i*a->plan.c, a->xy[2*i], a->xy[2*i+1], a->plan);
+}
+
+/// \brief Perform spline interpolation at many points.
+/// \details Points are distributed among threads, see
+/// \ref splinter_plan_with_nthreads.
+/// \param out array of n*c values, channels of each point being consecutive.
+/// \param xy array of 2n coordinates, x and y of each point being consecutive.
+/// \param n number of points.
+/// \param plan the plan created with \ref splinter_plan.
+void splinter_batch(double* out, const double* xy, int n,
+                    splinter_plan_t plan) {
+    batch_args_t args = {out, xy, plan};
+    splinter_parallel_for(n, batchRange, &args);
+}
+
+// ********************** precomputed sampling grid **************************
+
+/// \brief Kind of point of a sampling grid
+enum {GRID_TAPS, GRID_OUTSIDE, GRID_TAIL};
+
+/// \brief Points with their taps resolved, see \ref splinter_grid_create
+struct splinter_grid_s {
+    int n; ///< number of points
+    int kWidth; ///< number of taps in each direction
+    int w, h, order; ///< geometry of compatible plans
+    int shift, tn; ///< shift and kernel truncation of compatible plans
+    int (*ext)(int, int); ///< boundary extension of compatible plans
+    int tail; ///< whether compatible plans have coefficients beyond image
+    double* xy; ///< coordinates of points
+    unsigned char* kind; ///< GRID_TAPS, GRID_OUTSIDE or GRID_TAIL
+    int* index; ///< per point, kWidth columns then kWidth rows of taps
+    double* weight; ///< per point, kWidth weights in x, then in y
+};
+
+/// \brief Precompute the taps of interpolation at \a n points.
+/// \details For each point, the indices of the coefficients and the kernel
+/// weights computed by \ref splinter are stored, so that images of the same
+/// size are interpolated at the same points (a fixed remapping, e.g.) by
+/// \ref splinter_grid with only the weighted sums. The table is valid for
+/// all plans created with the same parameters as \a plan, except the image.
+/// \param xy array of 2n coordinates, x and y of each point being consecutive.
+splinter_grid_t* splinter_grid_create(const double* xy, int n,
+                                      splinter_plan_t plan) {
+    splinter_grid_t* g = malloc(sizeof*g);
+    const int kWidth = (plan.bspline->order==0)? 2: plan.bspline->order+1;
+    g->n = n;
+    g->kWidth = kWidth;
+    g->w = plan.w;
+    g->h = plan.h;
+    g->order = plan.bspline->order;
+    g->shift = plan.shift;
+    g->tn = plan.bspline->tn;
+    g->ext = plan.ext;
+    g->tail = (plan.tail != NULL);
+    g->xy = malloc(2*n*sizeof*g->xy);
+    memcpy(g->xy, xy, 2*n*sizeof*g->xy);
+    g->kind = malloc(n*sizeof*g->kind);
+    g->index = malloc(2*kWidth*(size_t)n*sizeof*g->index);
+    g->weight = malloc(2*kWidth*(size_t)n*sizeof*g->weight);
+
+    double radius = plan.bspline->radius;
+    const int shift = plan.shift;
+    int shift2 = (shift-plan.bspline->tn>0)? shift-plan.bspline->tn: 0;
+    for(int i=0; i<n; i++) {
+        double x = xy[2*i]+shift, y = xy[2*i+1]+shift;
+        int* ix = g->index + 2*kWidth*(size_t)i, *iy = ix + kWidth;
+        double* wx = g->weight + 2*kWidth*(size_t)i, *wy = wx + kWidth;
+        g->kind[i] = GRID_TAPS;
+#ifndef EXTRAPOLATE
+        if(! (shift<=x && x<=plan.w-1-shift && shift<=y && y<=plan.h-1-shift)){
+            g->kind[i] = GRID_OUTSIDE;
+            continue;
+        }
+#endif
+        int x0 = ceil(x-radius), y0 = ceil(y-radius);
+        if(plan.tail && (x0<0 || y0<0 || x0+kWidth>plan.w || y0+kWidth>plan.h)){
+            g->kind[i] = GRID_TAIL;
+            continue;
+        }
+        for(int k = 0; k < kWidth; k++) {
+            wx[k] = plan.bspline->eval(x-(x0+k), plan.bspline);
+            wy[k] = plan.bspline->eval(y-(y0+k), plan.bspline);
+            ix[k] = (shift2<=x0+k && x0+k<plan.w-shift2)?
+                x0+k: plan.ext(plan.w-2*shift, x0+k-shift)+shift;
+            iy[k] = (shift2<=y0+k && y0+k<plan.h-shift2)?
+                y0+k: plan.ext(plan.h-2*shift, y0+k-shift)+shift;
+        }
+    }
+    return g;
+}
+
+/// \brief Dispose of a grid created with \ref splinter_grid_create.
+void splinter_grid_destroy(splinter_grid_t* grid) {
+    free(grid->xy);
+    free(grid->kind);
+    free(grid->index);
+    free(grid->weight);
+    free(grid);
+}
+
+/// \brief Whether the taps of \a grid apply to \a plan: same geometry,
+/// kernel, boundary extension and tail.
+static int gridCompatible(const splinter_grid_t* grid, splinter_plan_t plan) {
+    return plan.bspline && plan.w==grid->w && plan.h==grid->h &&
+        plan.bspline->order==grid->order && plan.bspline->tn==grid->tn &&
+        plan.shift==grid->shift && plan.ext==grid->ext &&
+        (plan.tail!=NULL)==grid->tail;
+}
+
+/// \brief Interpolate at points [i0,i1) of the grid.
+/// \details The result is the same as calling \ref splinter at each point.
+/// If \a plan was not created with the same parameters as the one of
+/// \ref splinter_grid_create, the taps do not apply and \ref splinter is
+/// indeed called at each point.
+/// \param out array of (i1-i0)*c values, channels of each point being
+/// consecutive.
+void splinter_grid(double* out, const splinter_grid_t* grid,
+                   splinter_plan_t plan, int i0, int i1) {
+    if(! gridCompatible(grid, plan)) {
+        for(int i=i0; i<i1; i++, out+=plan.c)
+            splinter(out, grid->xy[2*i], grid->xy[2*i+1], plan);
+        return;
+    }
+    const int kWidth = grid->kWidth;
+    for(int i=i0; i<i1; i++, out+=plan.c) {
+        if(grid->kind[i] == GRID_TAIL) {
+            splinter(out, grid->xy[2*i], grid->xy[2*i+1], plan);
+            continue;
+        }
+        for(int c=0; c<plan.c; c++)
+            out[c] = 0;
+        if(grid->kind[i] == GRID_OUTSIDE)
+            continue;
+        const int* ix = grid->index + 2*kWidth*(size_t)i, *iy = ix + kWidth;
+        const double* wx = grid->weight + 2*kWidth*(size_t)i, *wy = wx+kWidth;
+        for(int l=0; l<kWidth; l++) {
+            const double* row = plan.prefilt + plan.w*(ptrdiff_t)iy[l];
+            for(int c=0; c<plan.c; c++) {
+                double s=0;
+                for(int k=0; k<kWidth; k++)
+                    s += row[ix[k]]*wx[k];
+                out[c] += s*wy[l];
+                row += plan.w*(ptrdiff_t)plan.h;
+            }
+        }
+    }
+}
+
+// ********************** rotation by shears *********************************
+
+/// \brief B-spline and prefilter of 1D lines, in a larger domain
+typedef struct {
+    Bspline bspline; ///< kernel
+    prefilter_t prefilter; ///< poles
+    int* truncation; ///< truncation values in the initializations
+    int* Lprecision; ///< larger domain extensions
+    int (*ext)(int, int); ///< boundary extension
+} line_filter_t;
+
+/// \brief Shift of line by a constant offset
+/// \details The n samples of the line are in buf[L2,L2+n), with
+/// L2=Lprecision[0], and the buffer has n+2*L2 elements. The line is
+/// extended and prefiltered in place, then out[m] receives the interpolated
+/// value at position t+m of the line, for m in [0,nOut). All output samples
+/// share the same kernel weights, so that the taps are accumulated along the
+/// line, in a loop vectorized by the compiler.
+static void shiftLine(const line_filter_t* f, double* buf, int n, double t,
+                      double* out, int nOut) {
+    const int* Lprecision = f->Lprecision;
+    int nPoles = f->prefilter.nPoles, L2 = Lprecision[0], n2 = n+2*L2;
+    int L3 = L2-Lprecision[nPoles];
+    for(int x=0; x<L2; x++) {
+        buf[x] = buf[L2+f->ext(n, x-L2)];
+        buf[n2-1-x] = buf[L2+f->ext(n, n-1-x+L2)];
+    }
+    for(int k=0; k<nPoles; k++)
+        expFilterExt(buf + (L2-Lprecision[k]), 1, n2-2*(L2-Lprecision[k]),
+                     f->prefilter.poles[k], f->truncation[k]);
+    if(f->prefilter.normalization != 1)
+        for(int x=L3; x<n2-L3; x++)
+            buf[x] *= f->prefilter.normalization;
+
+    const int kWidth = (f->bspline.order==0)? 2: f->bspline.order+1;
+    double x = t+L2, wt[kWidth];
+    int x0 = (int)ceil(x-f->bspline.radius);
+    for(int k=0; k<kWidth; k++)
+        wt[k] = f->bspline.eval(x-(x0+k), &f->bspline);
+    // Outputs [m0,m1) have all their taps in the prefiltered part of buf
+    int m0 = (L3-x0 > 0)? L3-x0: 0, m1 = n2-L3-kWidth+1-x0;
+    if(m1 > nOut) m1 = nOut;
+    if(m1 < m0) m1 = m0;
+    for(int m=m0; m<m1; m++)
+        out[m] = 0;
+    for(int k=0; k<kWidth; k++) {
+        const double* b = buf+x0+k;
+        for(int m=m0; m<m1; m++)
+            out[m] += b[m]*wt[k];
+    }
+    for(int m=0; m<nOut; m++) {
+        if(m == m0)
+            m = m1;
+        if(m >= nOut)
+            break;
+        double s = 0;
+        for(int k=0; k<kWidth; k++) {
+            int i = x0+m+k;
+            if(! (L3<=i && i<n2-L3))
+                i = f->ext(n, i-L2)+L2;
+            s += buf[i]*wt[k];
+        }
+        out[m] = s;
+    }
+}
+
+/// \brief Arguments of the parallel passes of rotation
+typedef struct {
+    const line_filter_t* f; ///< 1D prefilter and kernel
+    const void* in; ///< channel of input image
+    const splinter_layout_t* layout; ///< layout of input image
+    int w, h; ///< input dimensions
+    int quarter; ///< number of quarter turns applied to input
+    int wq, hq; ///< dimensions of input after quarter turns
+    double* I1; ///< first shear, nX x hq
+    double* I2; ///< second shear, nX x ho
+    int nX; ///< width of intermediate images
+    void* out; ///< channel of output image
+    const splinter_layout_t* outLayout; ///< layout of output image
+    int wo, ho; ///< output dimensions
+    double a, b; ///< shear factors
+    double tA, tB, tC; ///< offsets of the three shears
+    double iR[4]; ///< inverse rotation, to detect pixels outside input
+    double cx, cy; ///< rotation center
+} rotate_args_t;
+
+/// \brief Input sample at (x,y) of the input turned by \a quarter quarter
+/// turns
+static double quarterSample(const rotate_args_t* a, int x, int y) {
+    int ix=x, iy=y;
+    switch(a->quarter) {
+    case 1: ix = y; iy = a->h-1-x; break;
+    case 2: ix = a->w-1-x; iy = a->h-1-y; break;
+    case 3: ix = a->w-1-y; iy = x; break;
+    }
+    return sampleAt(a->in, a->layout->type,
+                    ix*a->layout->xStride + iy*a->layout->yStride);
+}
+
+/// \brief First shear, horizontal, of rows [y0,y1) of turned input
+static void shearRows(void* args, int y0, int y1) {
+    const rotate_args_t* a = args;
+    int L2 = a->f->Lprecision[0];
+    double* buf = malloc((a->wq+2*L2)*sizeof*buf);
+    for(int y=y0; y<y1; y++) {
+        for(int x=0; x<a->wq; x++)
+            buf[L2+x] = quarterSample(a, x, y);
+        shiftLine(a->f, buf, a->wq, a->tA + a->a*(y-(a->hq-1)/2.0),
+                  a->I1 + y*(ptrdiff_t)a->nX, a->nX);
+    }
+    free(buf);
+}
+
+/// \brief Second shear, vertical, of columns [x0,x1) of first shear
+static void shearColumns(void* args, int x0, int x1) {
+    const rotate_args_t* a = args;
+    int L2 = a->f->Lprecision[0];
+    double* buf = malloc((a->hq+2*L2)*sizeof*buf);
+    double* col = malloc(a->ho*sizeof*col);
+    for(int x=x0; x<x1; x++) {
+        for(int y=0; y<a->hq; y++)
+            buf[L2+y] = a->I1[x+y*(ptrdiff_t)a->nX];
+        shiftLine(a->f, buf, a->hq, a->tB + a->b*x, col, a->ho);
+        for(int y=0; y<a->ho; y++)
+            a->I2[x+y*(ptrdiff_t)a->nX] = col[y];
+    }
+    free(col);
+    free(buf);
+}
+
+/// \brief Third shear, horizontal, of rows [y0,y1) of output
+static void shearOutput(void* args, int y0, int y1) {
+    const rotate_args_t* a = args;
+    int L2 = a->f->Lprecision[0];
+    double* buf = malloc((a->nX+2*L2)*sizeof*buf);
+    double* row = malloc(a->wo*sizeof*row);
+    const splinter_layout_t* l = a->outLayout;
+    for(int y=y0; y<y1; y++) {
+        memcpy(buf+L2, a->I2 + y*(ptrdiff_t)a->nX, a->nX*sizeof*buf);
+        shiftLine(a->f, buf, a->nX, a->tC + a->a*y, row, a->wo);
+        for(int x=0; x<a->wo; x++) {
+#ifndef EXTRAPOLATE
+            double u = x-a->cx, v = y-a->cy;
+            double qx = a->iR[0]*u + a->iR[1]*v + (a->w-1)/2.0;
+            double qy = a->iR[2]*u + a->iR[3]*v + (a->h-1)/2.0;
+            if(! (0<=qx && qx<=a->w-1 && 0<=qy && qy<=a->h-1))
+                row[x] = 0;
+#endif
+            ptrdiff_t i = x*l->xStride + y*l->yStride;
+            if(l->type == SPLINTER_FLOAT32)
+                ((float*)a->out)[i] = (float)row[x];
+            else
+                ((double*)a->out)[i] = row[x];
+        }
+    }
+    free(row);
+    free(buf);
+}
+
+/// \brief Rotate an image by three 1D shears.
+/// \details Output pixel (i,j), at position p=(x0+i,y0+j), is the input
+/// interpolated at c+R(-angle)(p-c), where c is the center of the input and
+/// R(angle) the rotation matrix (cos -sin; sin cos): this is the homography
+/// of this rotation about c. The input is first turned exactly by a multiple
+/// of a quarter turn, then the remaining rotation, at most 45 degrees, is
+/// decomposed into horizontal, vertical and horizontal shears. Each shear
+/// shifts every row (or column) by a constant offset, with a 1D prefilter in
+/// a larger domain and the same kernel weights along the line. The result
+/// differs from the 2D interpolation of \ref splinter by the interpolation
+/// error of the intermediate images. Lines of each shear are distributed
+/// among threads, see \ref splinter_plan_with_nthreads.
+/// \param angle rotation angle in radians
+/// \return SPLINTER_OK if the output is complete.
+SplinterStatus splinter_rotate(void* out, splinter_layout_t outLayout,
+                               double x0, double y0, int wo, int ho,
+                               const void* in, splinter_layout_t layout,
+                               int w, int h, int c, int order, BoundaryExt e,
+                               double eps, double angle,
+                               const splinter_control_t* ctl) {
+    line_filter_t f;
+    get_bspline(order, &f.prefilter, &f.bspline);
+    int tn = f.prefilter.nPoles;
+    f.truncation = malloc(tn*sizeof*f.truncation);
+    if(tn > 0)
+        compute_truncation(f.truncation, f.prefilter.poles, tn, eps);
+    f.Lprecision = malloc((tn+1)*sizeof*f.Lprecision);
+    f.Lprecision[tn] = tn;
+    for(int i=tn-1; i>=0; i--)
+        f.Lprecision[i] = f.Lprecision[i+1] + f.truncation[i];
+    f.ext = ExtensionMethod[e];
+
+    // Exact quarter turns, then shears for the remaining angle
+    int quarter = (int)floor(angle/M_PI_2 + 0.5);
+    double theta = angle - quarter*M_PI_2;
+    quarter = ((quarter%4)+4)%4;
+    rotate_args_t a = {.f=&f, .layout=&layout, .w=w, .h=h, .quarter=quarter,
+                       .wq=(quarter%2)? h: w, .hq=(quarter%2)? w: h,
+                       .outLayout=&outLayout, .wo=wo, .ho=ho,
+                       .a=tan(theta/2), .b=-sin(theta)};
+    // Inverse rotation: exact quarter turns, then residual angle
+    static const int Q[4][4] = {{1,0,0,1}, {0,1,-1,0}, {-1,0,0,-1}, {0,-1,1,0}};
+    const int* q = Q[quarter];
+    double C = cos(theta), S = sin(theta);
+    a.iR[0] = q[0]*C - q[1]*S;
+    a.iR[1] = q[0]*S + q[1]*C;
+    a.iR[2] = q[2]*C - q[3]*S;
+    a.iR[3] = q[2]*S + q[3]*C;
+    a.cx = (w-1)/2.0-x0; // center in output pixel coordinates
+    a.cy = (h-1)/2.0-y0;
+
+    // Column k of intermediate images is at abscissa X=kStart+k-cx relative
+    // to the center, on the grid of output columns
+    double s0 = a.a*(-a.cy), s1 = a.a*(ho-1-a.cy);
+    int margin = f.Lprecision[0] + order+2;
+    int kStart = (int)floor(fmin(s0,s1)) - margin;
+    int kEnd = (int)ceil(fmax(s0,s1)) + wo-1 + margin;
+    a.nX = kEnd-kStart+1;
+    a.tA = (a.wq-1)/2.0 + kStart - a.cx;
+    a.tB = (a.hq-1)/2.0 - a.cy + a.b*(kStart - a.cx);
+    a.tC = -a.a*a.cy - kStart;
+    a.I1 = malloc(a.nX*(size_t)a.hq*sizeof(double));
+    a.I2 = malloc(a.nX*(size_t)ho*sizeof(double));
+
+    SplinterStatus status = SPLINTER_OK;
+    size_t size = typeSize(layout.type), outSize = typeSize(outLayout.type);
+    for(int l=0; l<c && status==SPLINTER_OK; l++) {
+        a.in = (const char*)in + l*layout.cStride*size;
+        a.out = (char*)out + l*outLayout.cStride*outSize;
+        status = splinter_parallel_for_control(a.hq, shearRows, &a, ctl);
+        if(status == SPLINTER_OK)
+            status = splinter_parallel_for_control(a.nX, shearColumns,&a,ctl);
+        if(status == SPLINTER_OK)
+            status = splinter_parallel_for_control(ho, shearOutput, &a, ctl);
+    }
+
+    free(a.I2);
+    free(a.I1);
+    free(f.Lprecision);
+    free(f.truncation);
+    if(order > MAX_TABULATED_ORDER) {
+        free(f.bspline.C);
+        free(f.prefilter.poles);
+    }
+    return status;
+}
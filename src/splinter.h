@@ -25,6 +25,7 @@
 #ifndef SPLINTER_H
 #define SPLINTER_H
 
+#include <stddef.h>
 #include "bspline.h"
 
 /// Boundary extension method used in prefiltering
@@ -35,6 +36,20 @@ typedef enum {
     BOUNDARY_PERIODIC = 3    ///< periodic
 } BoundaryExt;
 
+/// Scalar type of image buffers
+typedef enum {
+    SPLINTER_FLOAT64 = 0, ///< double
+    SPLINTER_FLOAT32 = 1  ///< float
+} SplinterType;
+
+/// \brief Memory layout of an image buffer
+/// \details Channel l of pixel (x,y) is at index
+/// x*xStride + y*yStride + l*cStride, in elements (not bytes).
+typedef struct {
+    SplinterType type; ///< scalar type
+    ptrdiff_t xStride, yStride, cStride; ///< strides in elements
+} splinter_layout_t;
+
 /// \brief Opaque structure, intended to be used for spline interpolation.
 /// \details The usage pattern is modeled after FFTW (http://www.fftw.org).
 /// To interpolate, the user must first create a plan with \ref splinter_plan.
@@ -47,13 +62,122 @@ typedef struct {
     int shift; ///< shift in each channel
     Bspline* bspline; ///< Bspline kernel
     int (*ext)(int, int); ///< get pixels of extended image
-    double *xBuf, *yBuf; ///< buffers for computation (internal usage)
+    double* tail; ///< coefficients beyond image (constant ext., exact domain)
+    struct splinter_setup_s* setup; ///< prefiltering parameters, for replan
 } splinter_plan_t;
 
+/// Status of computations that can be interrupted
+typedef enum {
+    SPLINTER_OK = 0,        ///< computation complete
+    SPLINTER_CANCELLED = 1, ///< interrupted by cancellation flag
+    SPLINTER_TIMEOUT = 2,   ///< interrupted at deadline
+    SPLINTER_INVALID = 3    ///< invalid parameters, nothing computed
+} SplinterStatus;
+
+/// \brief Cooperative interruption of plan creation and transforms
+/// \details Checked between bands of SPLINTER_BAND rows or columns of the
+/// image, rows of output tiles or output blocks.
+typedef struct {
+    const volatile int* cancel; ///< stop when *cancel is not 0 (may be NULL)
+    double deadline; ///< stop at this \ref splinter_clock time (0: none)
+} splinter_control_t;
+
+/// Rows, columns or blocks between interruption checks
+#define SPLINTER_BAND 16
+
 splinter_plan_t splinter_plan(const double* in, int w, int h, int c,
                               int order, BoundaryExt e, double eps, int larger);
+splinter_plan_t splinter_plan_layout(const void* in, splinter_layout_t layout,
+                                     int w, int h, int c, int order,
+                                     BoundaryExt e, double eps, int larger);
+splinter_plan_t splinter_plan_control(const void* in, splinter_layout_t layout,
+                                      int w, int h, int c, int order,
+                                      BoundaryExt e, double eps, int larger,
+                                      const splinter_control_t* ctl,
+                                      SplinterStatus* status);
+splinter_plan_t splinter_plan_inplace(double* in, int w, int h, int c,
+                                      int order, BoundaryExt e, double eps,
+                                      int larger);
+splinter_plan_t splinter_plan_region(const void* in, splinter_layout_t layout,
+                                     int w, int h, int c, int order,
+                                     BoundaryExt e, double eps, int region[4],
+                                     size_t budget);
+size_t splinter_plan_bytes(int w, int h, int c, int order,
+                           BoundaryExt e, double eps, int larger);
+void splinter_plan_sizes(int w, int h, int c, int order,
+                         BoundaryExt e, double eps, int larger,
+                         size_t* nPrefilt, size_t* nTail);
+splinter_plan_t splinter_plan_wrap(double* prefilt, double* tail,
+                                   const void* in, splinter_layout_t layout,
+                                   int w, int h, int c, int order,
+                                   BoundaryExt e, double eps, int larger);
+void splinter_plan_tiled(splinter_plan_t plan, int tile);
+void splinter_replan(splinter_plan_t* plan, const double* in);
+SplinterStatus splinter_replan_control(splinter_plan_t* plan, const void* in,
+                                       splinter_layout_t layout,
+                                       const splinter_control_t* ctl);
+void splinter_plan_readonly(splinter_plan_t plan);
+unsigned long splinter_plan_generation(splinter_plan_t plan);
 void splinter_destroy_plan(splinter_plan_t plan);
 
+splinter_layout_t splinter_layout_planar(int w, int h);
+splinter_layout_t splinter_layout_interleaved(int w, int c);
+
 void splinter(double* out, double x, double y, splinter_plan_t plan);
+void splinter_batch(double* out, const double* xy, int n,
+                    splinter_plan_t plan);
+/// Opaque table of interpolation taps at fixed points
+typedef struct splinter_grid_s splinter_grid_t;
+
+splinter_grid_t* splinter_grid_create(const double* xy, int n,
+                                      splinter_plan_t plan);
+void splinter_grid_destroy(splinter_grid_t* grid);
+void splinter_grid(double* out, const splinter_grid_t* grid,
+                   splinter_plan_t plan, int i0, int i1);
+SplinterStatus splinter_rotate(void* out, splinter_layout_t outLayout,
+                               double x0, double y0, int wo, int ho,
+                               const void* in, splinter_layout_t layout,
+                               int w, int h, int c, int order, BoundaryExt e,
+                               double eps, double angle,
+                               const splinter_control_t* ctl);
+
+/// Interpolation parameters with their measured cost and error
+typedef struct {
+    int order; ///< Spline order
+    double eps; ///< Precision of prefiltering
+    int larger; ///< Prefiltering in larger domain
+    double seconds; ///< Measured time of plan and transform
+    double error; ///< Measured interpolation error (NaN: not measured)
+} splinter_config_t;
+
+int splinter_pareto_front(int* front, const splinter_config_t* configs, int n);
+int splinter_cheapest_config(const splinter_config_t* configs, int n,
+                             double maxError);
+
+/// Task applied to a range [begin,end) of indices by \ref splinter_parallel_for
+typedef void (*splinter_range_fn)(void* arg, int begin, int end);
+
+/// \brief Scheduler of parallel tasks provided by the host application.
+/// \details \a submit must eventually run f(arg,begin,end), possibly in the
+/// calling thread, and return a handle that is passed once to \a wait, which
+/// returns when the task is complete.
+typedef struct {
+    void* (*submit)(void* ctx, splinter_range_fn f, void* arg,
+                    int begin, int end); ///< queue a task
+    void (*wait)(void* ctx, void* task); ///< wait for completion of task
+    void* ctx; ///< context of scheduler, first argument of its functions
+} splinter_scheduler_t;
+
+void splinter_plan_with_nthreads(int nthreads);
+int splinter_nthreads(void);
+void splinter_set_scheduler(const splinter_scheduler_t* s);
+void splinter_cleanup_threads(void);
+void splinter_parallel_for(int n, splinter_range_fn f, void* arg);
+void* splinter_submit(splinter_range_fn f, void* arg, int begin, int end);
+void splinter_wait(void* task);
+SplinterStatus splinter_parallel_for_control(int n, splinter_range_fn f,
+                                             void* arg,
+                                             const splinter_control_t* ctl);
+double splinter_clock(void);
 
 #endif
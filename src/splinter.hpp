@@ -0,0 +1,237 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter.hpp
+ * @brief C++ interface of spline interpolation
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPLINTER_HPP
+#define SPLINTER_HPP
+
+/// \file splinter.hpp
+/// Header-only C++17 wrapper of the C library, which remains the ABI. The
+/// namespace is spl, since splinter is the interpolation function:
+/// \code
+/// spl::Plan<float> plan(image, w, h, c, 11);  // RAII, move-only
+/// spl::Interpolator<11, float> interp(plan);  // Order fixed at compile
+/// interp(out, 1.3, 2.4);                      // time: unrolled taps
+/// \endcode
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#endif
+
+extern "C" {
+#include "splinter.h"
+}
+#include "bspline_tab.h"
+
+namespace spl {
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+template <class T> using span = std::span<T>;
+#else
+/// Minimal replacement of std::span (C++20): contiguous array and its size
+template <class T>
+class span {
+public:
+    span(T* data, std::size_t size): data_(data), size_(size) {}
+    /// Any contiguous container (std::vector, std::array...)
+    template <class C, class = decltype(std::declval<C&>().data())>
+    span(C& c): data_(c.data()), size_(c.size()) {}
+    T* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    T& operator[](std::size_t i) const { return data_[i]; }
+private:
+    T* data_;
+    std::size_t size_;
+};
+#endif
+
+/// Scalar type of image buffer
+template <class T> constexpr SplinterType scalar_type();
+template <> constexpr SplinterType scalar_type<double>() {
+    return SPLINTER_FLOAT64;
+}
+template <> constexpr SplinterType scalar_type<float>() {
+    return SPLINTER_FLOAT32;
+}
+
+/// \brief Owner of a splinter_plan_t, created from an image of scalar type T.
+/// \details Only movable, the plan is destroyed with its last owner. The
+/// prefiltered coefficients are double whatever T.
+template <class T>
+class Plan {
+    static_assert(std::is_same<T,double>::value||std::is_same<T,float>::value,
+                  "Plan<T> supports only double and float images");
+public:
+    /// Planar image: channel l of pixel (x,y) at index x+y*w+l*w*h
+    Plan(span<const T> image, int w, int h, int c, int order,
+         BoundaryExt e = BOUNDARY_HSYMMETRIC, double eps = 1e-6,
+         bool larger = false)
+    : Plan(image, splinter_layout_planar(w, h), w, h, c, order, e, eps,
+           larger) {}
+    /// Image of any layout, whose type must be T
+    Plan(span<const T> image, splinter_layout_t layout, int w, int h, int c,
+         int order, BoundaryExt e = BOUNDARY_HSYMMETRIC, double eps = 1e-6,
+         bool larger = false) {
+        layout.type = scalar_type<T>();
+        if(w <= 0 || h <= 0 || c <= 0 || order < 0 || order > MAX_ORDER)
+            throw std::invalid_argument("spl::Plan: wrong parameters");
+        std::ptrdiff_t last = (w-1)*layout.xStride + (h-1)*layout.yStride +
+            (c-1)*layout.cStride;
+        if(last < 0 || (std::size_t)last >= image.size())
+            throw std::invalid_argument("spl::Plan: image too small");
+        plan_ = splinter_plan_layout(image.data(), layout, w, h, c, order,
+                                     e, eps, larger);
+        valid_ = true;
+    }
+    ~Plan() { reset(); }
+    Plan(const Plan&) = delete;
+    Plan& operator=(const Plan&) = delete;
+    Plan(Plan&& p) noexcept: plan_(p.plan_), valid_(p.valid_) {
+        p.valid_ = false;
+    }
+    Plan& operator=(Plan&& p) noexcept {
+        if(this != &p) {
+            reset();
+            plan_ = p.plan_;
+            valid_ = p.valid_;
+            p.valid_ = false;
+        }
+        return *this;
+    }
+
+    /// Underlying C plan, for use with the C API. Do not destroy it.
+    const splinter_plan_t& get() const { return plan_; }
+    /// Whether the plan is owned (false once moved from)
+    explicit operator bool() const { return valid_; }
+
+    int width() const { return plan_.w - 2*plan_.shift; }
+    int height() const { return plan_.h - 2*plan_.shift; }
+    int channels() const { return plan_.c; }
+    int order() const { return plan_.bspline->order; }
+
+    /// Interpolate at (x,y), \a out must have channels() values
+    void operator()(span<double> out, double x, double y) const {
+        ::splinter(out.data(), x, y, plan_);
+    }
+    /// Interpolate at n points, \a xy has 2n coordinates and \a out n*c values
+    void batch(span<double> out, span<const double> xy) const {
+        ::splinter_batch(out.data(), xy.data(), (int)(xy.size()/2), plan_);
+    }
+
+private:
+    void reset() {
+        if(valid_)
+            splinter_destroy_plan(plan_);
+        valid_ = false;
+    }
+    splinter_plan_t plan_;
+    bool valid_ = false;
+};
+
+/// \brief B-spline of order \a Order at \a x, as the kernel \a b of a plan.
+/// \details The polynomials of tabulated orders are inlined; higher orders
+/// call the kernel of the plan.
+template <int Order>
+inline double bspline(double x, const Bspline* b) {
+    if constexpr(Order == 0) return bspline_tab0(x);
+    else if constexpr(Order == 1) return bspline_tab1(x);
+    else if constexpr(Order == 2) return bspline_tab2(x);
+    else if constexpr(Order == 3) return bspline_tab3(x);
+    else if constexpr(Order == 4) return bspline_tab4(x);
+    else if constexpr(Order == 5) return bspline_tab5(x);
+    else if constexpr(Order == 6) return bspline_tab6(x);
+    else if constexpr(Order == 7) return bspline_tab7(x);
+    else if constexpr(Order == 8) return bspline_tab8(x);
+    else if constexpr(Order == 9) return bspline_tab9(x);
+    else if constexpr(Order == 10) return bspline_tab10(x);
+    else if constexpr(Order == 11) return bspline_tab11(x);
+    else return b->eval(x, b);
+}
+
+/// \brief Interpolation with order known at compile time.
+/// \details The tap loops have fixed length and the kernel of tabulated
+/// orders is inlined, see \ref bspline, so that the compiler can unroll and
+/// vectorize them. Points whose kernel support leaves the image (or the
+/// domain of exact coefficients) are delegated to the C function splinter,
+/// which handles boundary extension.
+template <int Order, class T = double>
+class Interpolator {
+    static_assert(0 <= Order && Order <= MAX_ORDER, "Unsupported order");
+public:
+    /// B-spline of order 0 does not vanish at its support bounds
+    static constexpr int kWidth = (Order == 0)? 2: Order+1;
+
+    /// The plan must outlive the interpolator and have order \a Order
+    explicit Interpolator(const Plan<T>& plan): plan_(plan.get()) {
+        if(plan.order() != Order)
+            throw std::invalid_argument("spl::Interpolator: wrong order");
+        int tn = plan_.bspline->tn;
+        shift2_ = (plan_.shift-tn > 0)? plan_.shift-tn: 0;
+    }
+    Interpolator(Plan<T>&&) = delete; // Plan would be destroyed
+
+    /// Interpolate at (x,y), \a out must have plan.channels() values
+    void operator()(span<double> out, double x, double y) const {
+        const int s = plan_.shift;
+        const double radius = plan_.bspline->radius;
+        const double xs = x+s, ys = y+s;
+        const int x0 = (int)std::ceil(xs-radius);
+        const int y0 = (int)std::ceil(ys-radius);
+        if(!(s <= xs && xs <= plan_.w-1-s && s <= ys && ys <= plan_.h-1-s) ||
+           x0 < shift2_ || x0+kWidth > plan_.w-shift2_ ||
+           y0 < shift2_ || y0+kWidth > plan_.h-shift2_) {
+            ::splinter(out.data(), x, y, plan_);
+            return;
+        }
+        double xBuf[kWidth], yBuf[kWidth];
+        for(int k=0; k<kWidth; k++) {
+            xBuf[k] = bspline<Order>(xs-(x0+k), plan_.bspline);
+            yBuf[k] = bspline<Order>(ys-(y0+k), plan_.bspline);
+        }
+        const double* data = plan_.prefilt + x0 + (std::ptrdiff_t)y0*plan_.w;
+        for(int c=0; c<plan_.c; c++, data += (std::ptrdiff_t)plan_.w*plan_.h) {
+            double v = 0;
+            for(int l=0; l<kWidth; l++) {
+                const double* row = data + l*plan_.w;
+                double r = 0;
+                for(int k=0; k<kWidth; k++)
+                    r += row[k]*xBuf[k];
+                v += r*yBuf[l];
+            }
+            out[c] = v;
+        }
+    }
+
+private:
+    splinter_plan_t plan_;
+    int shift2_;
+};
+
+} // namespace spl
+
+#endif
@@ -0,0 +1,253 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_async.c
+ * @brief Asynchronous homography transforms
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// \file splinter_async.c
+/// Each job is cut in tiles of SPLINTER_TILE x SPLINTER_TILE pixels, computed
+/// by tasks submitted to the scheduler (\ref splinter_submit), at most
+/// \ref splinter_nthreads per job. A task does not compute the tiles of its
+/// job, but takes tiles from the pending jobs in turn, so that a large job does
+/// not delay the others. No task blocks, and no thread is kept by this module.
+
+#include "splinter_async.h"
+#include "splinter_transform.h"
+#include "homography_tools.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+/// An asynchronous transform
+struct splinter_job_s {
+    void* out; ///< output image
+    splinter_layout_t layout; ///< layout of output image
+    double x0, y0; ///< top-left corner of output area
+    int wout, hout; ///< size of output
+    splinter_plan_t plan; ///< interpolation plan
+    double iH[9]; ///< inverse homography
+    int tilesX, nTiles; ///< number of tiles in a row, total number
+    int nextTile; ///< first tile not yet taken by a task
+    int tilesDone; ///< number of tiles computed
+    int done; ///< whether all tiles are computed
+    int refs; ///< references held by user and queue
+    splinter_job_fn callback; ///< called at completion
+    void* user; ///< argument of callback
+    splinter_job_t* next; ///< next job with tiles to take
+};
+
+/// A task submitted to the scheduler
+typedef struct task_s {
+    void* handle; ///< handle returned by the scheduler
+    int done; ///< whether the task has computed its tiles
+    struct task_s* next; ///< next task not yet waited for
+} task_t;
+
+/// The queue of jobs. Members are protected by the mutex.
+static struct {
+    pthread_mutex_t mutex; ///< lock of queue, jobs and tasks
+    pthread_cond_t done; ///< signaled when a job is done
+    splinter_job_t *first, *last; ///< jobs with tiles to take
+    splinter_job_t* cursor; ///< job to take the next tile from
+    task_t* tasks; ///< submitted tasks not yet waited for
+} Queue = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+           NULL, NULL, NULL, NULL};
+
+/// Drop a reference to \a job, free it when none remains
+void splinter_job_release(splinter_job_t* job) {
+    pthread_mutex_lock(&Queue.mutex);
+    int refs = --job->refs;
+    pthread_mutex_unlock(&Queue.mutex);
+    if(refs == 0)
+        free(job);
+}
+
+/// Take the next tile, cycling through jobs. Queue must be locked and have
+/// jobs. The job is removed from the list once all its tiles are taken.
+static splinter_job_t* take_tile(int* tile) {
+    splinter_job_t* job = Queue.cursor? Queue.cursor: Queue.first;
+    *tile = job->nextTile++;
+    Queue.cursor = job->next;
+    if(job->nextTile == job->nTiles) { // Unlink job
+        splinter_job_t* prev = NULL;
+        for(splinter_job_t* j = Queue.first; j != job; j = j->next)
+            prev = j;
+        if(prev)
+            prev->next = job->next;
+        else
+            Queue.first = job->next;
+        if(Queue.last == job)
+            Queue.last = prev;
+    }
+    return job;
+}
+
+/// Compute a tile of \a job
+static void compute_tile(splinter_job_t* job, int tile) {
+    int i0 = (tile % job->tilesX)*SPLINTER_TILE;
+    int j0 = (tile / job->tilesX)*SPLINTER_TILE;
+    int i1 = (i0+SPLINTER_TILE < job->wout)? i0+SPLINTER_TILE: job->wout;
+    int j1 = (j0+SPLINTER_TILE < job->hout)? j0+SPLINTER_TILE: job->hout;
+    splinter_homography_tile(job->out, job->layout, job->x0, job->y0,
+                             i0, j0, i1, j1, job->plan, job->iH);
+}
+
+/// Mark \a job done, call its callback and drop the reference of the queue.
+/// Queue must be locked, it is unlocked.
+static void finish_job(splinter_job_t* job) {
+    job->done = 1;
+    pthread_cond_broadcast(&Queue.done);
+    pthread_mutex_unlock(&Queue.mutex);
+    if(job->callback)
+        job->callback(job, job->user);
+    splinter_job_release(job);
+}
+
+/// Task of the scheduler: compute end-begin tiles, taken from any job. As
+/// many tiles are queued as are owed by submitted tasks, so some are left.
+static void run_tiles(void* arg, int begin, int end) {
+    task_t* task = arg;
+    pthread_mutex_lock(&Queue.mutex);
+    for(int i=begin; i<end; i++) {
+        int tile;
+        splinter_job_t* job = take_tile(&tile);
+        pthread_mutex_unlock(&Queue.mutex);
+        compute_tile(job, tile);
+        pthread_mutex_lock(&Queue.mutex);
+        if(++job->tilesDone == job->nTiles) {
+            finish_job(job);
+            pthread_mutex_lock(&Queue.mutex);
+        }
+    }
+    task->done = 1;
+    pthread_mutex_unlock(&Queue.mutex);
+}
+
+/// Pass to the scheduler the handles of submitted tasks, either all of them,
+/// which completes all jobs, or only those already done, which does not
+/// block.
+static void wait_tasks(int all) {
+    task_t* list = NULL;
+    pthread_mutex_lock(&Queue.mutex);
+    for(task_t** t = &Queue.tasks; *t;) {
+        task_t* task = *t;
+        if(all || task->done) {
+            *t = task->next;
+            task->next = list;
+            list = task;
+        } else
+            t = &task->next;
+    }
+    pthread_mutex_unlock(&Queue.mutex);
+    while(list) {
+        task_t* task = list;
+        list = task->next;
+        splinter_wait(task->handle);
+        free(task);
+    }
+}
+
+/// \brief Submit a homography transform, see
+/// \ref splinter_homography_layout.
+/// \details The function returns immediately, unless the scheduler runs the
+/// tasks in the calling thread. The output image must not be accessed, nor
+/// the plan destroyed, before the job is done.
+/// \param callback function called by a task at completion (may be NULL).
+/// It may release the job, but not wait for a job.
+/// \param user argument passed to \a callback
+/// \return handle of the job, to be released by \ref splinter_job_release.
+splinter_job_t* splinter_homography_async(void *out, splinter_layout_t layout,
+                                          double x0, double y0,
+                                          int wout, int hout,
+                                          splinter_plan_t plan,
+                                          const double H[9],
+                                          splinter_job_fn callback,
+                                          void* user) {
+    wait_tasks(0);
+    splinter_job_t* job = malloc(sizeof*job);
+    job->out = out;
+    job->layout = layout;
+    job->x0 = x0;
+    job->y0 = y0;
+    job->wout = (wout > 0)? wout: 0;
+    job->hout = (hout > 0)? hout: 0;
+    job->plan = plan;
+    invert_homography(job->iH, H);
+    job->tilesX = (job->wout + SPLINTER_TILE-1) / SPLINTER_TILE;
+    job->nTiles = job->tilesX * ((job->hout + SPLINTER_TILE-1)/SPLINTER_TILE);
+    job->nextTile = job->tilesDone = job->done = 0;
+    job->refs = 2; // User and queue
+    job->callback = callback;
+    job->user = user;
+    job->next = NULL;
+
+    pthread_mutex_lock(&Queue.mutex);
+    if(job->nTiles == 0) { // Nothing to queue
+        finish_job(job);
+        return job;
+    }
+    if(Queue.last)
+        Queue.last->next = job;
+    else
+        Queue.first = job;
+    Queue.last = job;
+    pthread_mutex_unlock(&Queue.mutex);
+
+    int n = job->nTiles, nt = splinter_nthreads();
+    if(nt > n)
+        nt = n;
+    for(int i=0; i<nt; i++) {
+        task_t* task = malloc(sizeof*task);
+        task->done = 0;
+        task->handle = splinter_submit(run_tiles, task, i*n/nt, (i+1)*n/nt);
+        pthread_mutex_lock(&Queue.mutex);
+        task->next = Queue.tasks;
+        Queue.tasks = task;
+        pthread_mutex_unlock(&Queue.mutex);
+    }
+    return job;
+}
+
+/// \brief Whether \a job is done.
+int splinter_job_poll(splinter_job_t* job) {
+    pthread_mutex_lock(&Queue.mutex);
+    int done = job->done;
+    pthread_mutex_unlock(&Queue.mutex);
+    return done;
+}
+
+/// \brief Block until \a job is done.
+/// \details The tasks submitted so far are waited for, so that the scheduler
+/// may run them in the calling thread. Jobs submitted before are completed
+/// too.
+void splinter_job_wait(splinter_job_t* job) {
+    wait_tasks(1);
+    pthread_mutex_lock(&Queue.mutex);
+    while(! job->done)
+        pthread_cond_wait(&Queue.done, &Queue.mutex);
+    pthread_mutex_unlock(&Queue.mutex);
+}
+
+/// \brief Complete all submitted jobs and release their tasks.
+/// \details Must be called before the scheduler is changed or its workers
+/// stopped while jobs are pending.
+void splinter_async_shutdown(void) {
+    wait_tasks(1);
+}
@@ -0,0 +1,48 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_async.h
+ * @brief Asynchronous homography transforms
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPLINTERASYNC_H
+#define SPLINTERASYNC_H
+
+#include "splinter_transform.h"
+
+/// Opaque handle of an asynchronous transform
+typedef struct splinter_job_s splinter_job_t;
+
+/// Completion callback, called by a task of the scheduler when the job is done
+typedef void (*splinter_job_fn)(splinter_job_t* job, void* user);
+
+splinter_job_t* splinter_homography_async(void *out, splinter_layout_t layout,
+                                          double x0, double y0,
+                                          int wo, int ho,
+                                          splinter_plan_t plan,
+                                          const double homo[9],
+                                          splinter_job_fn callback,
+                                          void* user);
+int splinter_job_poll(splinter_job_t* job);
+void splinter_job_wait(splinter_job_t* job);
+void splinter_job_release(splinter_job_t* job);
+void splinter_async_shutdown(void);
+
+#endif
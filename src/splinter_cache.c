@@ -0,0 +1,289 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_cache.c
+ * @brief Cache of transformed tiles for panning viewports
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// \file splinter_cache.c
+/// The output plane is cut in tiles of SPLINTER_TILE x SPLINTER_TILE pixels
+/// on a fixed grid, so that a viewport moved by panning finds most of its
+/// tiles already computed. Tiles are identified by the plan (its coefficient
+/// array and order), the homography, the subpixel part of the viewport
+/// position and the tile coordinates. The generation of the plan is part of
+/// the key, so that tiles computed before \ref splinter_replan are not
+/// served; they are evicted as least recently used. The least recently used
+/// tiles are evicted when the memory budget is exceeded.
+
+#include "splinter_cache.h"
+#include "homography_tools.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NBUCKETS 1024 ///< Size of hash table
+
+/// Identification of a tile
+typedef struct {
+    const double* prefilt; ///< coefficients of plan
+    int order; ///< spline order of plan
+    unsigned long generation; ///< generation of coefficients, for replan
+    double H[9]; ///< homography
+    double fx, fy; ///< subpixel position of output grid
+    int tx, ty; ///< tile coordinates
+} tile_key_t;
+
+/// A computed tile
+typedef struct tile_s {
+    tile_key_t key; ///< identification
+    double* data; ///< values, planar channels of SPLINTER_TILE^2 pixels
+    size_t bytes; ///< memory used by the tile
+    struct tile_s *prev, *next; ///< neighbors in LRU list, most recent first
+    struct tile_s* chain; ///< next tile in hash bucket
+} tile_t;
+
+/// Cache of tiles. Calls are serialized by the mutex.
+struct splinter_cache_s {
+    pthread_mutex_t mutex; ///< lock of cache
+    size_t budget, bytes; ///< maximum and current memory of tiles
+    tile_t* buckets[NBUCKETS]; ///< hash table
+    tile_t *first, *last; ///< LRU list
+    long hits, misses; ///< statistics of tile lookups
+};
+
+/// Hash of a key (FNV-1a on its bytes, padding excluded)
+static unsigned hash_key(const tile_key_t* k) {
+    unsigned h = 2166136261u;
+    const unsigned char* bytes[] = {(const unsigned char*)&k->prefilt,
+                                    (const unsigned char*)&k->order,
+                                    (const unsigned char*)&k->generation,
+                                    (const unsigned char*)k->H,
+                                    (const unsigned char*)&k->fx,
+                                    (const unsigned char*)&k->fy,
+                                    (const unsigned char*)&k->tx,
+                                    (const unsigned char*)&k->ty};
+    size_t sizes[] = {sizeof(k->prefilt), sizeof(k->order),
+                      sizeof(k->generation), sizeof(k->H),
+                      sizeof(k->fx), sizeof(k->fy), sizeof(k->tx),
+                      sizeof(k->ty)};
+    for(int i=0; i<8; i++)
+        for(size_t j=0; j<sizes[i]; j++)
+            h = (h ^ bytes[i][j]) * 16777619u;
+    return h % NBUCKETS;
+}
+
+/// Equality of keys
+static int equal_keys(const tile_key_t* a, const tile_key_t* b) {
+    if(a->prefilt!=b->prefilt || a->order!=b->order ||
+       a->generation!=b->generation || a->tx!=b->tx || a->ty!=b->ty ||
+       a->fx!=b->fx || a->fy!=b->fy)
+        return 0;
+    for(int i=0; i<9; i++)
+        if(a->H[i] != b->H[i])
+            return 0;
+    return 1;
+}
+
+/// \brief Create a cache of tiles using at most \a budget bytes.
+splinter_cache_t* splinter_cache_create(size_t budget) {
+    splinter_cache_t* cache = calloc(1, sizeof*cache);
+    pthread_mutex_init(&cache->mutex, NULL);
+    cache->budget = budget;
+    return cache;
+}
+
+/// Remove \a t from LRU list
+static void unlink_lru(splinter_cache_t* cache, tile_t* t) {
+    if(t->prev)
+        t->prev->next = t->next;
+    else
+        cache->first = t->next;
+    if(t->next)
+        t->next->prev = t->prev;
+    else
+        cache->last = t->prev;
+}
+
+/// Insert \a t at head of LRU list
+static void push_lru(splinter_cache_t* cache, tile_t* t) {
+    t->prev = NULL;
+    t->next = cache->first;
+    if(cache->first)
+        cache->first->prev = t;
+    else
+        cache->last = t;
+    cache->first = t;
+}
+
+/// Remove tile \a t from cache and free it
+static void evict(splinter_cache_t* cache, tile_t* t) {
+    tile_t** p = &cache->buckets[hash_key(&t->key)];
+    while(*p != t)
+        p = &(*p)->chain;
+    *p = t->chain;
+    unlink_lru(cache, t);
+    cache->bytes -= t->bytes;
+    free(t->data);
+    free(t);
+}
+
+/// \brief Remove all tiles.
+/// \details Must be called when a plan is destroyed, since a new plan may
+/// reuse the address of its coefficients.
+void splinter_cache_clear(splinter_cache_t* cache) {
+    pthread_mutex_lock(&cache->mutex);
+    while(cache->last)
+        evict(cache, cache->last);
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+/// \brief Dispose of the cache and its tiles.
+void splinter_cache_destroy(splinter_cache_t* cache) {
+    splinter_cache_clear(cache);
+    pthread_mutex_destroy(&cache->mutex);
+    free(cache);
+}
+
+/// \brief Statistics: numbers of tiles found and computed, memory used.
+/// Any pointer may be NULL.
+void splinter_cache_stats(const splinter_cache_t* cache, long* hits,
+                          long* misses, size_t* bytes) {
+    if(hits)
+        *hits = cache->hits;
+    if(misses)
+        *misses = cache->misses;
+    if(bytes)
+        *bytes = cache->bytes;
+}
+
+/// Arguments of parallel computation of missing tiles
+typedef struct {
+    tile_t** tiles; ///< tiles to compute
+    splinter_plan_t plan; ///< interpolation plan
+    const double* iH; ///< inverse homography
+} tiles_args_t;
+
+/// Compute tiles [t0,t1)
+static void compute_tiles(void* args, int t0, int t1) {
+    const tiles_args_t* a = args;
+    splinter_layout_t l = splinter_layout_planar(SPLINTER_TILE, SPLINTER_TILE);
+    for(int t=t0; t<t1; t++) {
+        const tile_key_t* k = &a->tiles[t]->key;
+        splinter_homography_tile(a->tiles[t]->data, l,
+                                 k->tx*SPLINTER_TILE + k->fx,
+                                 k->ty*SPLINTER_TILE + k->fy,
+                                 0, 0, SPLINTER_TILE, SPLINTER_TILE,
+                                 a->plan, a->iH);
+    }
+}
+
+/// Floor division
+static int floor_div(int a, int b) {
+    return (a >= 0)? a/b: -((-a+b-1)/b);
+}
+
+/// \brief Apply homography, see \ref splinter_homography_layout, reusing the
+/// tiles computed by previous calls.
+/// \details Only the missing tiles are computed, in parallel, and stored in
+/// the cache. Output pixel (i,j) is at (x0+i,y0+j), so that panning changes
+/// only (x0,y0). The most recently used tiles are kept within budget, but
+/// all tiles of the current call are computed even if they exceed it.
+void splinter_homography_cached(splinter_cache_t* cache,
+                                void *out, splinter_layout_t layout,
+                                double x0, double y0, int wout, int hout,
+                                splinter_plan_t plan, const double H[9]) {
+    if(wout <= 0 || hout <= 0)
+        return;
+    double iH[9];
+    invert_homography(iH, H);
+    int ix0 = (int)floor(x0), iy0 = (int)floor(y0);
+    int tx0 = floor_div(ix0, SPLINTER_TILE);
+    int ty0 = floor_div(iy0, SPLINTER_TILE);
+    int tx1 = floor_div(ix0+wout-1, SPLINTER_TILE);
+    int ty1 = floor_div(iy0+hout-1, SPLINTER_TILE);
+    int nx = tx1-tx0+1, n = nx*(ty1-ty0+1), nMissing = 0, c = plan.c;
+    size_t bytes = sizeof(tile_t) +
+        (size_t)c*SPLINTER_TILE*SPLINTER_TILE*sizeof(double);
+    tile_t** tiles = malloc(n*sizeof*tiles);
+    tile_t** missing = malloc(n*sizeof*missing);
+
+    pthread_mutex_lock(&cache->mutex);
+    for(int t=0; t<n; t++) {
+        tile_key_t k;
+        memset(&k, 0, sizeof(k));
+        k.prefilt = plan.prefilt;
+        k.order = plan.bspline->order;
+        k.generation = splinter_plan_generation(plan);
+        memcpy(k.H, H, sizeof(k.H));
+        k.fx = x0-ix0;
+        k.fy = y0-iy0;
+        k.tx = tx0 + t%nx;
+        k.ty = ty0 + t/nx;
+        tile_t* tile = cache->buckets[hash_key(&k)];
+        while(tile && !equal_keys(&tile->key, &k))
+            tile = tile->chain;
+        if(tile) {
+            ++cache->hits;
+            unlink_lru(cache, tile);
+        } else {
+            ++cache->misses;
+            tile = malloc(sizeof*tile);
+            tile->key = k;
+            tile->data = malloc(c*SPLINTER_TILE*SPLINTER_TILE*sizeof(double));
+            tile->bytes = bytes;
+            unsigned b = hash_key(&k);
+            tile->chain = cache->buckets[b];
+            cache->buckets[b] = tile;
+            cache->bytes += bytes;
+            missing[nMissing++] = tile;
+        }
+        push_lru(cache, tile);
+        tiles[t] = tile;
+    }
+    tiles_args_t args = {missing, plan, iH};
+    splinter_parallel_for(nMissing, compute_tiles, &args);
+
+    // Copy tiles to output
+    for(int t=0; t<n; t++) {
+        const tile_key_t* k = &tiles[t]->key;
+        int i0 = k->tx*SPLINTER_TILE - ix0, j0 = k->ty*SPLINTER_TILE - iy0;
+        for(int j = (j0>0)? j0: 0; j < j0+SPLINTER_TILE && j < hout; j++)
+            for(int i = (i0>0)? i0: 0; i < i0+SPLINTER_TILE && i < wout; i++){
+                const double* v = tiles[t]->data +
+                    (i-i0) + (j-j0)*SPLINTER_TILE;
+                ptrdiff_t idx = i*layout.xStride + j*layout.yStride;
+                for(int l=0; l<c; l++, idx+=layout.cStride)
+                    if(layout.type == SPLINTER_FLOAT32)
+                        ((float*)out)[idx] =
+                            (float)v[l*SPLINTER_TILE*SPLINTER_TILE];
+                    else
+                        ((double*)out)[idx] = v[l*SPLINTER_TILE*SPLINTER_TILE];
+            }
+    }
+
+    // Evict least recently used tiles, except those of this call
+    while(cache->bytes > cache->budget && cache->last &&
+          cache->bytes > (size_t)n*bytes)
+        evict(cache, cache->last);
+    pthread_mutex_unlock(&cache->mutex);
+    free(missing);
+    free(tiles);
+}
@@ -0,0 +1,43 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_cache.h
+ * @brief Cache of transformed tiles for panning viewports
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPLINTERCACHE_H
+#define SPLINTERCACHE_H
+
+#include "splinter_transform.h"
+
+/// Opaque cache of tiles
+typedef struct splinter_cache_s splinter_cache_t;
+
+splinter_cache_t* splinter_cache_create(size_t budget);
+void splinter_cache_destroy(splinter_cache_t* cache);
+void splinter_cache_clear(splinter_cache_t* cache);
+void splinter_cache_stats(const splinter_cache_t* cache, long* hits,
+                          long* misses, size_t* bytes);
+void splinter_homography_cached(splinter_cache_t* cache,
+                                void *out, splinter_layout_t layout,
+                                double x0, double y0, int wo, int ho,
+                                splinter_plan_t plan, const double homo[9]);
+
+#endif
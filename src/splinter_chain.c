@@ -0,0 +1,174 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_chain.c
+ * @brief Composition of geometric transforms resampled once
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/// \file splinter_chain.c
+/// A pipeline of geometric corrections (lens undistortion, homography,
+/// crop and scale...) is resampled only once: the transforms are composed
+/// into a single mapping from output to input positions, so that the input
+/// is prefiltered once and no intermediate image is computed, nor clipped.
+/// Consecutive homographies are merged by matrix product, and a chain
+/// reduced to a homography uses the regular homographic transform. Other
+/// transforms are given by their inverse mapping.
+
+#include "splinter_chain.h"
+#include "homography_tools.h"
+#include <stdlib.h>
+#include <string.h>
+
+/// A transform of the chain
+typedef struct {
+    double H[9]; ///< homography, if map is NULL
+    double iH[9]; ///< inverse homography, if map is NULL
+    splinter_map_fn map; ///< inverse mapping
+    void* data; ///< user data of map
+} step_t;
+
+/// Chain of transforms, in order of application to the input
+struct splinter_chain_s {
+    step_t* steps; ///< transforms
+    int n; ///< number of transforms
+};
+
+/// \brief Create an empty chain (identity transform).
+splinter_chain_t* splinter_chain_create(void) {
+    return calloc(1, sizeof(splinter_chain_t));
+}
+
+/// \brief Dispose of the chain.
+void splinter_chain_destroy(splinter_chain_t* chain) {
+    free(chain->steps);
+    free(chain);
+}
+
+/// Append an empty step to \a chain
+static step_t* push_step(splinter_chain_t* chain) {
+    chain->steps = realloc(chain->steps, (chain->n+1)*sizeof(step_t));
+    step_t* s = chain->steps + chain->n++;
+    memset(s, 0, sizeof(*s));
+    return s;
+}
+
+/// \brief Append homography \a H, applied after the transforms already in
+/// \a chain. It is merged with a preceding homography.
+void splinter_chain_homography(splinter_chain_t* chain, const double H[9]) {
+    step_t* s = chain->n? chain->steps + chain->n-1: NULL;
+    if(!s || s->map) {
+        s = push_step(chain);
+        memcpy(s->H, H, sizeof(s->H));
+    } else {
+        double P[9];
+        for(int i=0; i<3; i++)
+            for(int j=0; j<3; j++)
+                P[3*i+j] = H[3*i]*s->H[j] + H[3*i+1]*s->H[3+j] +
+                    H[3*i+2]*s->H[6+j];
+        memcpy(s->H, P, sizeof(s->H));
+    }
+    invert_homography(s->iH, s->H);
+}
+
+/// \brief Append a transform given by its inverse mapping \a map, applied
+/// after the transforms already in \a chain.
+void splinter_chain_map(splinter_chain_t* chain,
+                        splinter_map_fn map, void* data) {
+    step_t* s = push_step(chain);
+    s->map = map;
+    s->data = data;
+}
+
+/// \brief Whether \a chain is a homography, put in \a H if not NULL.
+int splinter_chain_is_homography(const splinter_chain_t* chain, double H[9]) {
+    static const double id[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    if(chain->n > 1 || (chain->n == 1 && chain->steps[0].map))
+        return 0;
+    if(H)
+        memcpy(H, chain->n? chain->steps[0].H: id, 9*sizeof(double));
+    return 1;
+}
+
+/// \brief Position \a in in the input of the chain of point \a out of its
+/// output.
+void splinter_chain_point(const splinter_chain_t* chain,
+                          double in[2], const double out[2]) {
+    double p[2] = {out[0], out[1]};
+    for(int k=chain->n-1; k>=0; k--) {
+        const step_t* s = chain->steps + k;
+        if(s->map)
+            s->map(in, p, s->data);
+        else
+            apply_homography(in, p, s->iH);
+        p[0] = in[0];
+        p[1] = in[1];
+    }
+    in[0] = p[0];
+    in[1] = p[1];
+}
+
+/// Arguments of the parallel tasks of chain transform
+typedef struct {
+    void* out; ///< output image
+    splinter_layout_t layout; ///< layout of output image
+    double x0, y0; ///< top-left corner of output area
+    int wout; ///< width of output
+    splinter_plan_t plan; ///< interpolation plan
+    const splinter_chain_t* chain; ///< transforms
+} chain_args_t;
+
+/// Interpolate rows [j0,j1) of output
+static void chain_rows(void* args, int j0, int j1) {
+    const chain_args_t* a = args;
+    int c = a->plan.c;
+    double p[2], q[2];
+    double* outp = malloc(c*sizeof*outp);
+    for(int j = j0; j < j1; j++) {
+        p[1] = j+a->y0;
+        for(int i = 0; i < a->wout; i++) {
+            p[0] = i+a->x0;
+            splinter_chain_point(a->chain, q, p);
+            splinter(outp, q[0], q[1], a->plan);
+            splinter_store_pixel(a->out, a->layout, i, j, outp, c);
+        }
+    }
+    free(outp);
+}
+
+/// \brief Resample once through the chain of transforms, see
+/// \ref splinter_homography_control.
+/// \details The plan is that of the input of the first transform. No
+/// intermediate image is clipped: a point leaving the domain of an
+/// intermediate image and coming back in the end is still interpolated.
+/// \return SPLINTER_OK if the output is complete.
+SplinterStatus splinter_chain_transform(void *out, splinter_layout_t layout,
+                                        double x0, double y0,
+                                        int wout, int hout,
+                                        splinter_plan_t plan,
+                                        const splinter_chain_t* chain,
+                                        const splinter_control_t* ctl) {
+    double H[9];
+    if(splinter_chain_is_homography(chain, H))
+        return splinter_homography_control(out, layout, x0, y0, wout, hout,
+                                           plan, H, ctl);
+    chain_args_t args = {out, layout, x0, y0, wout, plan, chain};
+    return splinter_parallel_for_control(hout, chain_rows, &args, ctl);
+}
@@ -0,0 +1,54 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_chain.h
+ * @brief Composition of geometric transforms resampled once
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SPLINTERCHAIN_H
+#define SPLINTERCHAIN_H
+
+#include "splinter_transform.h"
+
+/// Inverse mapping of a transform: position \a in, in the input of the
+/// transform, of point \a out of its output. It is called concurrently by
+/// several threads.
+typedef void (*splinter_map_fn)(double in[2], const double out[2], void* data);
+
+/// Opaque chain of transforms
+typedef struct splinter_chain_s splinter_chain_t;
+
+splinter_chain_t* splinter_chain_create(void);
+void splinter_chain_destroy(splinter_chain_t* chain);
+void splinter_chain_homography(splinter_chain_t* chain, const double homo[9]);
+void splinter_chain_map(splinter_chain_t* chain,
+                        splinter_map_fn map, void* data);
+int splinter_chain_is_homography(const splinter_chain_t* chain,
+                                 double homo[9]);
+void splinter_chain_point(const splinter_chain_t* chain,
+                          double in[2], const double out[2]);
+SplinterStatus splinter_chain_transform(void *out, splinter_layout_t layout,
+                                        double x0, double y0, int wo, int ho,
+                                        splinter_plan_t plan,
+                                        const splinter_chain_t* chain,
+                                        const splinter_control_t* ctl);
+
+#endif
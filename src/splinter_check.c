@@ -0,0 +1,982 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_check.c
+ * @brief Differential accuracy check of interpolation paths
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "iio.h"
+#include "splinter_transform.h"
+#include "splinter_async.h"
+#include "splinter_warp.h"
+#include "splinter_preview.h"
+#include "splinter_cache.h"
+#include "splinter_shm.h"
+#include "splinter_mesh.h"
+#include "splinter_chain.h"
+#include "splinter_polar.h"
+#include "homography_tools.h"
+#include "xmtime.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/// Signature of an interpolation path, see \ref splinter_homography_geom.
+typedef void (*warp_fn)(double *out, double x0, double y0, int wo, int ho,
+                        const double *in, int w, int h, int c,
+                        int order, BoundaryExt boundary, double eps,
+                        const double H[9]);
+
+/// Reference: scalar double implementation in the exact domain
+static void warp_reference(double *out, double x0, double y0, int wo, int ho,
+                           const double *in, int w, int h, int c,
+                           int order, BoundaryExt boundary, double eps,
+                           const double H[9]) {
+    splinter_homography_geom(out, x0, y0, wo, ho, in, w, h, c,
+                             order, boundary, eps, 0, H);
+}
+
+/// Prefiltering in the larger domain
+static void warp_larger(double *out, double x0, double y0, int wo, int ho,
+                        const double *in, int w, int h, int c,
+                        int order, BoundaryExt boundary, double eps,
+                        const double H[9]) {
+    splinter_homography_geom(out, x0, y0, wo, ho, in, w, h, c,
+                             order, boundary, eps, 1, H);
+}
+
+/// Multithreaded prefiltering and transform
+static void warp_threads(double *out, double x0, double y0, int wo, int ho,
+                         const double *in, int w, int h, int c,
+                         int order, BoundaryExt boundary, double eps,
+                         const double H[9]) {
+    int n = splinter_nthreads();
+    splinter_plan_with_nthreads(4);
+    splinter_homography_geom(out, x0, y0, wo, ho, in, w, h, c,
+                             order, boundary, eps, 0, H);
+    splinter_plan_with_nthreads(n);
+}
+
+/// Asynchronous transform, output cut in two jobs interleaved by workers
+static void warp_async(double *out, double x0, double y0, int wo, int ho,
+                       const double *in, int w, int h, int c,
+                       int order, BoundaryExt boundary, double eps,
+                       const double H[9]) {
+    splinter_plan_t plan = splinter_plan(in, w, h, c, order, boundary, eps, 0);
+    splinter_layout_t layout = splinter_layout_planar(wo, ho);
+    int h1 = ho/2;
+    splinter_job_t* jobs[2];
+    jobs[0] = splinter_homography_async(out, layout, x0, y0, wo, h1,
+                                        plan, H, NULL, NULL);
+    jobs[1] = splinter_homography_async(out+h1*wo, layout, x0, y0+h1, wo,
+                                        ho-h1, plan, H, NULL, NULL);
+    for(int i=0; i<2; i++) {
+        splinter_job_wait(jobs[i]);
+        splinter_job_release(jobs[i]);
+    }
+    splinter_destroy_plan(plan);
+}
+
+/// Resumable transform by slices of 1000 pixels, centered viewport first
+static void warp_sliced(double *out, double x0, double y0, int wo, int ho,
+                        const double *in, int w, int h, int c,
+                        int order, BoundaryExt boundary, double eps,
+                        const double H[9]) {
+    splinter_plan_t plan = splinter_plan(in, w, h, c, order, boundary, eps, 0);
+    splinter_warp_t* warp = splinter_warp_init(out,
+                                               splinter_layout_planar(wo, ho),
+                                               x0, y0, wo, ho, plan, H);
+    splinter_warp_viewport(warp, wo/4, ho/4, wo/2, ho/2);
+    while(splinter_warp_step(warp, 0, 1000) > 0)
+        ;
+    splinter_warp_finish(warp);
+    splinter_destroy_plan(plan);
+}
+
+/// Progressive transform from a draft of order 1
+static void warp_preview(double *out, double x0, double y0, int wo, int ho,
+                         const double *in, int w, int h, int c,
+                         int order, BoundaryExt boundary, double eps,
+                         const double H[9]) {
+    splinter_preview_t* p = splinter_preview(out,
+                                             splinter_layout_planar(wo, ho),
+                                             x0, y0, wo, ho,
+                                             in, splinter_layout_planar(w, h),
+                                             w, h, c, 1, order, boundary, eps,
+                                             0, H, NULL, NULL);
+    splinter_preview_wait(p);
+    splinter_preview_release(p);
+}
+
+/// Tile cache, filled by a view panned by (-37,-21) before the actual one
+static void warp_cached(double *out, double x0, double y0, int wo, int ho,
+                        const double *in, int w, int h, int c,
+                        int order, BoundaryExt boundary, double eps,
+                        const double H[9]) {
+    splinter_plan_t plan = splinter_plan(in, w, h, c, order, boundary, eps, 0);
+    splinter_cache_t* cache = splinter_cache_create(1<<24);
+    splinter_layout_t layout = splinter_layout_planar(wo, ho);
+    splinter_homography_cached(cache, out, layout, x0-37, y0-21, wo, ho,
+                               plan, H);
+    splinter_homography_cached(cache, out, layout, x0, y0, wo, ho, plan, H);
+    splinter_cache_destroy(cache);
+    splinter_destroy_plan(plan);
+}
+
+/// Plan created on the mirrored image, then recomputed from the actual one.
+/// The tiles cached before replan must not be reused.
+static void warp_replan(double *out, double x0, double y0, int wo, int ho,
+                        const double *in, int w, int h, int c,
+                        int order, BoundaryExt boundary, double eps,
+                        const double H[9]) {
+    double* mirror = malloc(w*h*c*sizeof*mirror);
+    for(int i=0; i<w*h*c; i++)
+        mirror[i] = in[w*h*c-1-i];
+    splinter_plan_t plan = splinter_plan(mirror, w, h, c, order, boundary,
+                                         eps, 0);
+    free(mirror);
+    splinter_cache_t* cache = splinter_cache_create(1<<24);
+    splinter_layout_t layout = splinter_layout_planar(wo, ho);
+    splinter_homography_cached(cache, out, layout, x0, y0, wo, ho, plan, H);
+    splinter_replan(&plan, in);
+    splinter_homography_cached(cache, out, layout, x0, y0, wo, ho, plan, H);
+    splinter_cache_destroy(cache);
+    splinter_destroy_plan(plan);
+}
+
+/// Memory budget of half the plan: footprints of tiles prefiltered in turn
+static void warp_budget(double *out, double x0, double y0, int wo, int ho,
+                        const double *in, int w, int h, int c,
+                        int order, BoundaryExt boundary, double eps,
+                        const double H[9]) {
+    size_t budget = splinter_warp_bytes(wo, ho, SPLINTER_FLOAT64, w, h, c,
+                                        order, boundary, eps, 1) -
+        splinter_plan_bytes(w, h, c, order, boundary, eps, 1)/2;
+    splinter_homography_budget(out, splinter_layout_planar(wo, ho), x0, y0,
+                               wo, ho, in, splinter_layout_planar(w, h),
+                               w, h, c, order, boundary, eps, 1, H, budget);
+}
+
+/// Plan created in shared memory, then attached read-only
+static void warp_shared(double *out, double x0, double y0, int wo, int ho,
+                        const double *in, int w, int h, int c,
+                        int order, BoundaryExt boundary, double eps,
+                        const double H[9]) {
+    char name[64];
+    sprintf(name, "/splinter_check_%ld", (long)getpid());
+    splinter_plan_t owner = splinter_shm_create(name, in,
+                                                splinter_layout_planar(w, h),
+                                                w, h, c, order, boundary,
+                                                eps, 0);
+    splinter_plan_t plan = splinter_shm_attach(name, w, h, c, order,
+                                               boundary, eps, 0);
+    splinter_shm_unlink(name);
+    splinter_shm_detach(owner);
+    if(plan.prefilt)
+        splinter_homography_with_plan(out, x0, y0, wo, ho, plan, H);
+    splinter_shm_detach(plan);
+}
+
+/// Mesh warp of 5x3 cells with the same homography
+static void warp_mesh(double *out, double x0, double y0, int wo, int ho,
+                      const double *in, int w, int h, int c,
+                      int order, BoundaryExt boundary, double eps,
+                      const double H[9]) {
+    double cells[5*3*9];
+    for(int k=0; k<5*3*9; k++)
+        cells[k] = H[k%9];
+    splinter_plan_t plan = splinter_plan(in, w, h, c, order, boundary, eps, 0);
+    splinter_mesh_homographies(out, splinter_layout_planar(wo, ho), x0, y0,
+                               wo, ho, plan, 5, 3, cells, NULL);
+    splinter_destroy_plan(plan);
+}
+
+/// Inverse mapping of translation by vector \a data
+static void untranslate(double in[2], const double out[2], void* data) {
+    const double* d = data;
+    in[0] = out[0]-d[0];
+    in[1] = out[1]-d[1];
+}
+
+/// Chain of H, a translation given by mapping and the opposite translation
+static void warp_chain(double *out, double x0, double y0, int wo, int ho,
+                       const double *in, int w, int h, int c,
+                       int order, BoundaryExt boundary, double eps,
+                       const double H[9]) {
+    double d[2] = {3.5, -2.25}, T[9] = {1, 0, -d[0], 0, 1, -d[1], 0, 0, 1};
+    splinter_chain_t* chain = splinter_chain_create();
+    splinter_chain_homography(chain, H);
+    splinter_chain_map(chain, untranslate, d);
+    splinter_chain_homography(chain, T);
+    splinter_plan_t plan = splinter_plan(in, w, h, c, order, boundary, eps, 0);
+    splinter_chain_transform(out, splinter_layout_planar(wo, ho), x0, y0,
+                             wo, ho, plan, chain, NULL);
+    splinter_destroy_plan(plan);
+    splinter_chain_destroy(chain);
+}
+
+/// Coefficients stored in Morton-ordered tiles of 16x16 with halo
+static void warp_tiled(double *out, double x0, double y0, int wo, int ho,
+                       const double *in, int w, int h, int c,
+                       int order, BoundaryExt boundary, double eps,
+                       const double H[9]) {
+    splinter_plan_t plan = splinter_plan(in, w, h, c, order, boundary, eps, 0);
+    splinter_plan_tiled(plan, 16);
+    splinter_homography_with_plan(out, x0, y0, wo, ho, plan, H);
+    splinter_destroy_plan(plan);
+}
+
+/// Taps precomputed at the preimages of output pixels
+static void warp_grid(double *out, double x0, double y0, int wo, int ho,
+                      const double *in, int w, int h, int c,
+                      int order, BoundaryExt boundary, double eps,
+                      const double H[9]) {
+    double iH[9], *xy = malloc(2*wo*ho*sizeof*xy), *v = malloc(c*sizeof*v);
+    invert_homography(iH, H);
+    for(int j=0; j<ho; j++)
+        for(int i=0; i<wo; i++) {
+            double p[2] = {x0+i, y0+j};
+            apply_homography(xy+2*(i+j*wo), p, iH);
+        }
+    splinter_plan_t plan = splinter_plan(in, w, h, c, order, boundary, eps, 0);
+    splinter_grid_t* grid = splinter_grid_create(xy, wo*ho, plan);
+    for(int i=0; i<wo*ho; i++) {
+        splinter_grid(v, grid, plan, i, i+1);
+        for(int k=0; k<c; k++)
+            out[i+k*wo*ho] = v[k];
+    }
+    splinter_grid_destroy(grid);
+    splinter_destroy_plan(plan);
+    free(v);
+    free(xy);
+}
+
+/// Preimages interpolated in blocks, within a sixteenth of \a eps pixels
+static void warp_approx(double *out, double x0, double y0, int wo, int ho,
+                        const double *in, int w, int h, int c,
+                        int order, BoundaryExt boundary, double eps,
+                        const double H[9]) {
+    splinter_plan_t plan = splinter_plan(in, w, h, c, order, boundary, eps, 0);
+    splinter_homography_approx(out, splinter_layout_planar(wo, ho), x0, y0,
+                               wo, ho, plan, H, eps/16, NULL);
+    splinter_destroy_plan(plan);
+}
+
+/// Input and output of type float with interleaved channels
+static void warp_float32(double *out, double x0, double y0, int wo, int ho,
+                         const double *in, int w, int h, int c,
+                         int order, BoundaryExt boundary, double eps,
+                         const double H[9]) {
+    float* fin = malloc((size_t)w*h*c*sizeof*fin);
+    float* fout = malloc((size_t)wo*ho*c*sizeof*fout);
+    for(int i=0; i<w*h; i++)
+        for(int k=0; k<c; k++)
+            fin[i*c+k] = (float)in[i+k*w*h];
+    splinter_layout_t layout = splinter_layout_interleaved(w, c);
+    splinter_layout_t outLayout = splinter_layout_interleaved(wo, c);
+    layout.type = outLayout.type = SPLINTER_FLOAT32;
+    splinter_plan_t plan = splinter_plan_layout(fin, layout, w, h, c, order,
+                                                boundary, eps, 0);
+    splinter_homography_layout(fout, outLayout, x0, y0, wo, ho, plan, H);
+    splinter_destroy_plan(plan);
+    for(int i=0; i<wo*ho; i++)
+        for(int k=0; k<c; k++)
+            out[i+k*wo*ho] = fout[i*c+k];
+    free(fout);
+    free(fin);
+}
+
+/// Rotation by shears, \a H being a rotation about the center of the image
+static void warp_rotate(double *out, double x0, double y0, int wo, int ho,
+                        const double *in, int w, int h, int c,
+                        int order, BoundaryExt boundary, double eps,
+                        const double H[9]) {
+    splinter_rotate(out, splinter_layout_planar(wo, ho), x0, y0, wo, ho,
+                    in, splinter_layout_planar(w, h), w, h, c, order,
+                    boundary, eps, atan2(H[3], H[0]), NULL);
+}
+
+/// An interpolation path to compare to the reference
+typedef struct {
+    const char* name; ///< Name displayed in report
+    warp_fn warp; ///< Warping function
+    double precision; ///< Smallest tolerance, relative to the amplitude
+} path_t;
+
+/// The paths to check. Any new implementation should be registered here.
+static const path_t Paths[] = {
+    {"larger", warp_larger, 0},
+    {"threads", warp_threads, 0},
+    {"async", warp_async, 0},
+    {"sliced", warp_sliced, 0},
+    {"preview", warp_preview, 0},
+    {"cached", warp_cached, 0},
+    {"replan", warp_replan, 0},
+    {"budget", warp_budget, 0},
+    {"shared", warp_shared, 0},
+    {"mesh", warp_mesh, 0},
+    {"chain", warp_chain, 0},
+    {"grid", warp_grid, 0},
+    {"tiled", warp_tiled, 0},
+    {"approx", warp_approx, 0},
+    {"float32", warp_float32, 1e-6} // Rounding of input and output
+};
+
+static const int Orders[] = {0, 1, 2, 3, 5, 7, 9, 11};
+static const int Precisions[] = {3, 6, 9}; ///< eps=10^-p
+static const char* BoundaryNames[] = {"constant","hsymmetric",
+                                      "wsymmetric","periodic"};
+
+/// Test transforms: subpixel shift, rotation with perspective
+static const double Homographies[][9] = {
+    {1, 0, 0.5, 0, 1, 0, 0, 0, 1},
+    {0.95, -0.3, 20, 0.3, 0.95, -15, 1e-4, -2e-4, 1}
+};
+
+/// Time in seconds of a call to \a warp, repeated for at least 10ms.
+static double time_warp(warp_fn warp, double *out, const double *in,
+                        int w, int h, int c, int order, BoundaryExt b,
+                        double eps, const double H[9]) {
+    int n = 0;
+    unsigned long t0 = xmtime(), t;
+    do {
+        warp(out, 0, 0, w, h, in, w, h, c, order, b, eps, H);
+        ++n;
+    } while((t=xmtime()-t0) < 10);
+    return t/(1000.0*n);
+}
+
+/// Maximum and root mean square of difference
+static void compare(double *maxErr, double *rms,
+                    const double *a, const double *b, int n) {
+    *maxErr = *rms = 0;
+    for(int i=0; i<n; i++) {
+        double d = fabs(a[i]-b[i]);
+        if(d > *maxErr)
+            *maxErr = d;
+        *rms += d*d;
+    }
+    *rms = sqrt(*rms/n);
+}
+
+/// Check all paths against reference for image \a in. Return number of
+/// failures.
+static int check_image(const char* name, const double *in, int w, int h, int c){
+    int failures = 0;
+    double amplitude = 0;
+    for(int i=0; i<w*h*c; i++)
+        if(fabs(in[i]) > amplitude)
+            amplitude = fabs(in[i]);
+    double *ref = malloc(w*h*c*sizeof*ref);
+    double *out = malloc(w*h*c*sizeof*out);
+    int nOrders = sizeof(Orders)/sizeof(*Orders);
+    int nPrec = sizeof(Precisions)/sizeof(*Precisions);
+    int nHomo = sizeof(Homographies)/sizeof(*Homographies);
+    int nPaths = sizeof(Paths)/sizeof(*Paths);
+    for(int o=0; o<nOrders; o++)
+        for(int b=0; b<4; b++)
+            for(int p=0; p<nPrec; p++)
+                for(int t=0; t<nHomo; t++) {
+                    double eps = pow(10, -Precisions[p]);
+                    const double* H = Homographies[t];
+                    double tRef = time_warp(warp_reference, ref, in, w, h, c,
+                                            Orders[o], b, eps, H);
+                    for(int i=0; i<nPaths; i++) {
+                        double tPath = time_warp(Paths[i].warp, out, in,
+                                                 w, h, c, Orders[o], b, eps, H);
+                        double maxErr, rms;
+                        compare(&maxErr, &rms, ref, out, w*h*c);
+                        double tol = fmax(2*eps, Paths[i].precision);
+                        int ok = (maxErr <= tol*amplitude);
+                        failures += !ok;
+                        printf("%-10s %-8s %2d %-10s 1e-%d H%d "
+                               "%10.3g %10.3g %6.2fx %s\n",
+                               name, Paths[i].name, Orders[o],
+                               BoundaryNames[b], Precisions[p], t,
+                               maxErr, rms, tRef/tPath, ok? "ok": "FAIL");
+                    }
+                }
+    // Rotation by shears interpolates intermediate images, so that it matches
+    // the reference only for quarter turns
+    double cx = (w-1)/2.0, cy = (h-1)/2.0;
+    for(int o=0; o<nOrders; o++)
+        for(int b=0; b<4; b++)
+            for(int p=0; p<nPrec; p++)
+                for(int q=1; q<=2; q++) {
+                    double eps = pow(10, -Precisions[p]);
+                    double C = (q==2)? -1: 0, S = (q==1)? 1: 0;
+                    double H[9] = {C, -S, cx-C*cx+S*cy, S, C, cy-S*cx-C*cy,
+                                   0, 0, 1};
+                    double tRef = time_warp(warp_reference, ref, in, w, h, c,
+                                            Orders[o], b, eps, H);
+                    double tPath = time_warp(warp_rotate, out, in, w, h, c,
+                                             Orders[o], b, eps, H);
+                    double maxErr, rms;
+                    compare(&maxErr, &rms, ref, out, w*h*c);
+                    int ok = (maxErr <= 2*eps*amplitude);
+                    failures += !ok;
+                    printf("%-10s %-8s %2d %-10s 1e-%d Q%d "
+                           "%10.3g %10.3g %6.2fx %s\n",
+                           name, "rotate", Orders[o], BoundaryNames[b],
+                           Precisions[p], q, maxErr, rms, tRef/tPath,
+                           ok? "ok": "FAIL");
+                }
+    // Polar and log-polar resampling against interpolation at same points
+    int nRings = h/2, nAngles = w;
+    double* polar = malloc(nRings*nAngles*c*sizeof*polar);
+    for(int o=0; o<nOrders; o++)
+        for(int b=0; b<4; b++)
+            for(int lp=0; lp<=1; lp++) {
+                double rMax = 0.6*(w<h? w: h), v[c];
+                splinter_plan_t plan = splinter_plan(in, w, h, c, Orders[o],
+                                                     b, 1e-6, 0);
+                splinter_polar_t* pattern = splinter_polar_create(plan, cx, cy,
+                                                  1, rMax, nRings, nAngles, lp);
+                splinter_polar(polar, splinter_layout_planar(nAngles, nRings),
+                               pattern, plan, NULL);
+                double maxErr = 0;
+                for(int j=0; j<nRings; j++)
+                    for(int i=0; i<nAngles; i++) {
+                        double t = (double)j/(nRings-1);
+                        double r = lp? pow(rMax, t): 1+(rMax-1)*t;
+                        double a = 2*M_PI*i/nAngles;
+                        splinter(v, cx+r*cos(a), cy+r*sin(a), plan);
+                        for(int k=0; k<c; k++) {
+                            double d = fabs(v[k]-polar[i+(j+k*nRings)*nAngles]);
+                            if(d > maxErr)
+                                maxErr = d;
+                        }
+                    }
+                splinter_polar_destroy(pattern);
+                splinter_destroy_plan(plan);
+                int ok = (maxErr <= 2e-6*amplitude);
+                failures += !ok;
+                printf("%-10s %-8s %2d %-10s 1e-6 P%d %10.3g %s\n", name,
+                       "polar", Orders[o], BoundaryNames[b], lp, maxErr,
+                       ok? "ok": "FAIL");
+            }
+    free(polar);
+    free(ref);
+    free(out);
+    return failures;
+}
+
+/// Synthetic images: white noise, smooth ramp, single impulse, checkerboard.
+static double* synthetic_image(int type, int w, int h) {
+    double* im = malloc(w*h*sizeof*im);
+    srand(1);
+    for(int y=0; y<h; y++)
+        for(int x=0; x<w; x++) {
+            double v=0;
+            switch(type) {
+            case 0: v = rand()/(double)RAND_MAX; break;
+            case 1: v = (x+2*y)/(double)(w+2*h); break;
+            case 2: v = (x==w/2 && y==h/2); break;
+            case 3: v = ((x/4+y/4)%2); break;
+            }
+            im[x+w*y] = v;
+        }
+    return im;
+}
+
+/// Cancellation raised from another thread during a computation
+typedef struct {
+    volatile int cancel; ///< flag of \ref splinter_control_t
+    double delay; ///< delay before raising the flag, in seconds
+    double time; ///< time at which the flag was raised
+} canceller_t;
+
+/// Thread raising the flag of a \ref canceller_t after its delay
+static void* raise_cancel(void* arg) {
+    canceller_t* c = arg;
+    struct timespec t = {0, (long)(c->delay*1e9)};
+    nanosleep(&t, NULL);
+    c->time = splinter_clock();
+    c->cancel = 1;
+    return NULL;
+}
+
+/// Print the status of an interrupted computation and return 1 if it is not
+/// the expected one
+static int report_control(const char* path, const char* test,
+                          SplinterStatus status, SplinterStatus expected) {
+    const char* names[] = {"ok", "cancelled", "timeout", "invalid"};
+    printf("control    %-8s %-10s %-10s %s\n", path, test, names[status],
+           (status==expected)? "ok": "FAIL");
+    return status != expected;
+}
+
+/// Check interruption of plan creation and homography: a flag already raised
+/// or a past deadline must stop them before any output, and a flag raised
+/// during a homography must stop it within a few bands of pixels.
+static int check_control(void) {
+    const int w=1024, h=1024, order=11;
+    double *in = malloc(w*h*sizeof*in), *out = malloc(w*h*sizeof*out);
+    for(int i=0; i<w*h; i++)
+        in[i] = (i*7919)%255;
+    splinter_layout_t layout = splinter_layout_planar(w, h);
+    volatile int raised = 1;
+    splinter_control_t cancel = {&raised, 0};
+    splinter_control_t late = {NULL, fmax(splinter_clock()-1, 1e-9)};
+    SplinterStatus st;
+    int failures = 0;
+    splinter_plan_t plan = splinter_plan_control(in, layout, w, h, 1, order,
+                                                 BOUNDARY_HSYMMETRIC, 1e-6, 0,
+                                                 &cancel, &st);
+    failures += report_control("plan", "flag", st, SPLINTER_CANCELLED);
+    failures += (plan.prefilt != NULL);
+    plan = splinter_plan_control(in, layout, w, h, 1, order,
+                                 BOUNDARY_HSYMMETRIC, 1e-6, 0, &late, &st);
+    failures += report_control("plan", "deadline", st, SPLINTER_TIMEOUT);
+    failures += (plan.prefilt != NULL);
+
+    plan = splinter_plan(in, w, h, 1, order, BOUNDARY_HSYMMETRIC, 1e-6, 0);
+    const double* H = Homographies[1];
+    for(int i=0; i<w*h; i++)
+        out[i] = -1;
+    st = splinter_homography_control(out, layout, 0, 0, w, h, plan, H, &cancel);
+    failures += report_control("warp", "flag", st, SPLINTER_CANCELLED);
+    st = splinter_homography_control(out, layout, 0, 0, w, h, plan, H, &late);
+    failures += report_control("warp", "deadline", st, SPLINTER_TIMEOUT);
+    int written = 0;
+    for(int i=0; i<w*h; i++)
+        written += (out[i] != -1);
+    failures += (written != 0);
+
+    // Flag raised after 20ms: return within 0.1s (bands of at most 16 rows of
+    // 128 pixels take a few milliseconds)
+    canceller_t c = {0, 0.02, 0};
+    splinter_control_t ctl = {&c.cancel, 0};
+    pthread_t thread;
+    pthread_create(&thread, NULL, raise_cancel, &c);
+    st = splinter_homography_control(out, layout, 0, 0, w, h, plan, H, &ctl);
+    double latency = splinter_clock() - c.time;
+    pthread_join(thread, NULL);
+    failures += report_control("warp", "raised", st, SPLINTER_CANCELLED);
+    int ok = (latency <= 0.1);
+    failures += !ok;
+    printf("control    %-8s %-10s %10.3gs %s\n", "warp", "latency", latency,
+           ok? "ok": "FAIL");
+    splinter_destroy_plan(plan);
+    free(out);
+    free(in);
+    return failures;
+}
+
+/// Scheduler of the host, running tasks in the calling thread, either at
+/// submission (inline) or when waited for (deferred)
+typedef struct {
+    int inline_; ///< run tasks at submission
+    int submitted; ///< number of submitted tasks
+} test_scheduler_t;
+
+/// Task of \ref test_scheduler_t
+typedef struct {
+    splinter_range_fn f;
+    void* arg;
+    int begin, end, done;
+} test_task_t;
+
+/// Submission to \ref test_scheduler_t
+static void* test_submit(void* ctx, splinter_range_fn f, void* arg,
+                         int begin, int end) {
+    test_scheduler_t* s = ctx;
+    test_task_t* t = malloc(sizeof*t);
+    test_task_t task = {f, arg, begin, end, 0};
+    *t = task;
+    ++s->submitted;
+    if(s->inline_) {
+        f(arg, begin, end);
+        t->done = 1;
+    }
+    return t;
+}
+
+/// Wait of \ref test_scheduler_t
+static void test_wait(void* ctx, void* task) {
+    (void)ctx;
+    test_task_t* t = task;
+    if(! t->done)
+        t->f(t->arg, t->begin, t->end);
+    free(t);
+}
+
+/// Check that asynchronous transforms and previews run their background
+/// work as tasks of the scheduler, even one running them in the caller
+static int check_scheduler(const double* in, int w, int h) {
+    const double* H = Homographies[1];
+    double *ref = malloc(w*h*sizeof*ref), *out = malloc(w*h*sizeof*out);
+    warp_reference(ref, 0, 0, w, h, in, w, h, 1, 3, BOUNDARY_HSYMMETRIC, 1e-6,
+                   H);
+    double amplitude = 0;
+    for(int i=0; i<w*h; i++)
+        amplitude = fmax(amplitude, fabs(in[i]));
+    const char* names[] = {"async", "preview"};
+    warp_fn warps[] = {warp_async, warp_preview};
+    int failures = 0;
+    for(int i=0; i<2; i++)
+        for(int inl=0; inl<2; inl++) {
+            test_scheduler_t ts = {inl, 0};
+            splinter_scheduler_t s = {test_submit, test_wait, &ts};
+            splinter_set_scheduler(&s);
+            warps[i](out, 0, 0, w, h, in, w, h, 1, 3, BOUNDARY_HSYMMETRIC,
+                     1e-6, H);
+            splinter_set_scheduler(NULL);
+            double maxErr, rms;
+            compare(&maxErr, &rms, ref, out, w*h);
+            int ok = (maxErr <= 2e-6*amplitude && ts.submitted > 0);
+            failures += !ok;
+            printf("scheduler  %-8s %-10s %10.3g %10d %s\n", names[i],
+                   inl? "inline": "deferred", maxErr, ts.submitted,
+                   ok? "ok": "FAIL");
+        }
+    free(out);
+    free(ref);
+    return failures;
+}
+
+/// Check that plans in shared memory, created or attached, are not replanned
+/// and that their coefficients are left unchanged
+static int check_shared_replan(const double* in, int w, int h) {
+    char name[64];
+    sprintf(name, "/splinter_check_%ld", (long)getpid());
+    splinter_layout_t layout = splinter_layout_planar(w, h);
+    splinter_plan_t owner = splinter_shm_create(name, in, layout, w, h, 1, 3,
+                                                BOUNDARY_HSYMMETRIC, 1e-6, 0);
+    splinter_plan_t plan = splinter_shm_attach(name, w, h, 1, 3,
+                                               BOUNDARY_HSYMMETRIC, 1e-6, 0);
+    splinter_shm_unlink(name);
+    int ok = (owner.prefilt && plan.prefilt);
+    if(ok) {
+        double* zero = calloc(w*h, sizeof*zero);
+        double before = owner.prefilt[w/2 + h/2*owner.w];
+        ok = splinter_replan_control(&owner, zero, layout, NULL) ==
+            SPLINTER_INVALID &&
+            splinter_replan_control(&plan, zero, layout, NULL) ==
+            SPLINTER_INVALID &&
+            owner.prefilt[w/2 + h/2*owner.w] == before;
+        splinter_replan(&plan, zero); // Must not write the read-only mapping
+        free(zero);
+    }
+    splinter_shm_detach(owner);
+    splinter_shm_detach(plan);
+    printf("shm        replan   %s\n", ok? "ok": "FAIL");
+    return !ok;
+}
+
+/// Check that a grid used with a plan of other parameters than the one it was
+/// created with still gives the values of \ref splinter for that plan
+static int check_grid_mismatch(const double* in, int w, int h) {
+    const int n = 500;
+    double xy[2*n], v[1], ref[1], maxErr = 0;
+    srand(3);
+    for(int i=0; i<2*n; i++)
+        xy[i] = -2 + (((i%2)? h: w)+4)*(rand()/(double)RAND_MAX);
+    splinter_plan_t plan = splinter_plan(in, w, h, 1, 3, BOUNDARY_HSYMMETRIC,
+                                         1e-6, 0);
+    splinter_grid_t* grid = splinter_grid_create(xy, n, plan);
+    splinter_destroy_plan(plan);
+    const BoundaryExt other[] = {BOUNDARY_PERIODIC, BOUNDARY_CONSTANT,
+                                 BOUNDARY_HSYMMETRIC};
+    const int larger[] = {0, 0, 1};
+    for(int k=0; k<3; k++) {
+        plan = splinter_plan(in, w, h, 1, 3, other[k], 1e-6, larger[k]);
+        for(int i=0; i<n; i++) {
+            splinter_grid(v, grid, plan, i, i+1);
+            splinter(ref, xy[2*i], xy[2*i+1], plan);
+            maxErr = fmax(maxErr, fabs(v[0]-ref[0]));
+        }
+        splinter_destroy_plan(plan);
+    }
+    splinter_grid_destroy(grid);
+    printf("grid       mismatch %10.3g %s\n", maxErr,
+           (maxErr==0)? "ok": "FAIL");
+    return maxErr != 0;
+}
+
+/// Smooth analytic image, whose rotations are known exactly
+static double smooth(double x, double y) {
+    return sin(0.07*x + 0.03*y) + cos(0.05*y - 0.02*x);
+}
+
+/// Check rotation by shears at angles that are not quarter turns, where the
+/// shears are not trivial. The error to the exact rotation of a smooth image,
+/// away from borders, must be of the order of that of the reference.
+static int check_rotation_angles(void) {
+    const int w=128, h=96, margin=16;
+    const double angles[] = {0.3, 1.15, 2.0}, eps=1e-9;
+    double *in = malloc(w*h*sizeof*in), *ref = malloc(w*h*sizeof*ref);
+    double *out = malloc(w*h*sizeof*out);
+    for(int y=0; y<h; y++)
+        for(int x=0; x<w; x++)
+            in[x+w*y] = smooth(x, y);
+    double cx = (w-1)/2.0, cy = (h-1)/2.0;
+    int failures = 0, nOrders = sizeof(Orders)/sizeof(*Orders);
+    for(int o=0; o<nOrders; o++)
+        for(int b=0; b<4; b++)
+            for(int a=0; a<3; a++) {
+                double C = cos(angles[a]), S = sin(angles[a]);
+                double H[9] = {C, -S, cx-C*cx+S*cy, S, C, cy-S*cx-C*cy,
+                               0, 0, 1};
+                warp_reference(ref, 0, 0, w, h, in, w, h, 1, Orders[o], b,
+                               eps, H);
+                warp_rotate(out, 0, 0, w, h, in, w, h, 1, Orders[o], b, eps, H);
+                double errRef = 0, errRot = 0;
+                for(int j=0; j<h; j++)
+                    for(int i=0; i<w; i++) {
+                        double x = cx + C*(i-cx) + S*(j-cy);
+                        double y = cy - S*(i-cx) + C*(j-cy);
+                        if(x < margin || x > w-1-margin ||
+                           y < margin || y > h-1-margin)
+                            continue;
+                        double v = smooth(x, y);
+                        errRef = fmax(errRef, fabs(ref[i+w*j]-v));
+                        errRot = fmax(errRot, fabs(out[i+w*j]-v));
+                    }
+                int ok = (errRot <= 5*errRef + 1e-8);
+                failures += !ok;
+                printf("%-10s %-8s %2d %-10s 1e-9 A%d %10.3g %10.3g %s\n",
+                       "smooth", "rotate", Orders[o], BoundaryNames[b], a,
+                       errRot, errRef, ok? "ok": "FAIL");
+            }
+    free(out);
+    free(ref);
+    free(in);
+    return failures;
+}
+
+/// Check mesh warps on image \a in. With a distinct translation per cell, each
+/// pixel must be interpolated with the homography of the cell containing it.
+/// With vertices sampled from one homography, the result must match the
+/// reference.
+static int check_mesh(const double* in, int w, int h) {
+    const int nx=5, ny=3, order=3;
+    const double eps = 1e-6;
+    double cells[9*nx*ny], xy[2*(nx+1)*(ny+1)];
+    double *ref = malloc(w*h*sizeof*ref), *out = malloc(w*h*sizeof*out);
+    splinter_plan_t plan = splinter_plan(in, w, h, 1, order,
+                                         BOUNDARY_HSYMMETRIC, eps, 0);
+    splinter_layout_t layout = splinter_layout_planar(w, h);
+    for(int k=0; k<nx*ny; k++) {
+        double T[9] = {1, 0, 0.3*k-1, 0, 1, 0.7-0.1*k*k, 0, 0, 1};
+        for(int i=0; i<9; i++)
+            cells[9*k+i] = T[i];
+    }
+    splinter_mesh_homographies(out, layout, 0, 0, w, h, plan, nx, ny, cells,
+                               NULL);
+    double maxErr = 0;
+    for(int j=0; j<h; j++)
+        for(int i=0; i<w; i++) {
+            double iH[9], p[2] = {i, j}, q[2], v;
+            invert_homography(iH, cells + 9*((j*ny/h)*nx + i*nx/w));
+            apply_homography(q, p, iH);
+            splinter(&v, q[0], q[1], plan);
+            maxErr = fmax(maxErr, fabs(v-out[i+w*j]));
+        }
+    int failures = (maxErr != 0);
+    printf("%-10s %-8s %2d %-10s 1e-6 T  %10.3g %s\n", "noise", "mesh",
+           order, BoundaryNames[BOUNDARY_HSYMMETRIC], maxErr,
+           failures? "FAIL": "ok");
+
+    const double* H = Homographies[1];
+    double iH[9];
+    invert_homography(iH, H);
+    for(int b=0; b<=ny; b++)
+        for(int a=0; a<=nx; a++) {
+            double p[2] = {(double)a*w/nx, (double)b*h/ny};
+            apply_homography(xy+2*(b*(nx+1)+a), p, iH);
+        }
+    splinter_homography_with_plan(ref, 0, 0, w, h, plan, H);
+    splinter_mesh_vertices(out, layout, 0, 0, w, h, plan, nx, ny, xy, NULL);
+    double rms;
+    compare(&maxErr, &rms, ref, out, w*h);
+    int ok = (maxErr <= 2*eps);
+    failures += !ok;
+    printf("%-10s %-8s %2d %-10s 1e-6 V  %10.3g %s\n", "noise", "mesh",
+           order, BoundaryNames[BOUNDARY_HSYMMETRIC], maxErr, ok? "ok": "FAIL");
+    int invalid = (splinter_mesh_homographies(out, layout, 0, 0, w, h, plan,
+                                              0, ny, cells, NULL)
+                   == SPLINTER_INVALID);
+    failures += !invalid;
+    printf("%-10s %-8s no cell %s\n", "noise", "mesh", invalid? "ok": "FAIL");
+    splinter_destroy_plan(plan);
+    free(out);
+    free(ref);
+    return failures;
+}
+
+/// Largest difference of homographies normalized by their last coefficient
+static double homography_distance(const double A[9], const double B[9]) {
+    double d = 0;
+    for(int i=0; i<9; i++)
+        d = fmax(d, fabs(A[i]/A[8] - B[i]/B[8]));
+    return d;
+}
+
+/// Print the result of a homography solver and return 1 if it fails
+static int report_solver(const char* path, const char* test, double err,
+                         int ok) {
+    printf("homography %-8s %-10s %10.3g %s\n", path, test, err,
+           ok? "ok": "FAIL");
+    return !ok;
+}
+
+/// Check the homography solvers: recovery of a known homography from exact
+/// and noisy correspondences, and rejection of coincident points.
+static int check_solvers(void) {
+    enum {N = 20}; // Correspondences of DLT problems
+    const double* H = Homographies[1];
+    double src[8*N], dst[8*N], noisy[2*N], R[9*N];
+    int failures = 0;
+    srand(2);
+    for(int i=0; i<4*N; i++) {
+        src[2*i] = 128.0*rand()/RAND_MAX;
+        src[2*i+1] = 96.0*rand()/RAND_MAX;
+        apply_homography(dst+2*i, src+2*i, H);
+    }
+    // Closed form: N problems of 4 correspondences
+    homographies_from_4corresp(N, src, dst, R);
+    double err = 0;
+    for(int k=0; k<N; k++)
+        err = fmax(err, homography_distance(R+9*k, H));
+    failures += report_solver("4corresp", "exact", err, err <= 1e-9);
+
+    // DLT of one problem, then of 12 problems of sizes 4 to 7 at once, more
+    // than are solved together
+    homography_dlt(N, src, dst, R);
+    err = homography_distance(R, H);
+    failures += report_solver("dlt", "exact", err, err <= 1e-9);
+    int start[13] = {0};
+    for(int k=0; k<12; k++)
+        start[k+1] = start[k] + 4+k%4;
+    homographies_dlt(12, start, src, dst, R);
+    err = 0;
+    for(int k=0; k<12; k++)
+        err = fmax(err, homography_distance(R+9*k, H));
+    failures += report_solver("dlt", "batch", err, err <= 1e-9);
+
+    // Noise of 0.01 pixel: reprojection error of the same order
+    for(int i=0; i<2*N; i++)
+        noisy[i] = dst[i] + 0.02*(rand()/(double)RAND_MAX-0.5);
+    homography_dlt(N, src, noisy, R);
+    err = 0;
+    for(int i=0; i<N; i++) {
+        double q[2];
+        apply_homography(q, src+2*i, R);
+        err = fmax(err, hypot(q[0]-dst[2*i], q[1]-dst[2*i+1]));
+    }
+    failures += report_solver("dlt", "noise", err, err <= 0.02);
+
+    // Coincident source points: failure and NaN
+    for(int i=1; i<N; i++) {
+        src[2*i] = src[0];
+        src[2*i+1] = src[1];
+    }
+    int st = homography_dlt(N, src, dst, R);
+    failures += report_solver("dlt", "degenerate", st, st==-1 && isnan(R[0]));
+    int starts[] = {0, N, 2*N};
+    st = homographies_dlt(2, starts, src, dst, R);
+    err = homography_distance(R+9, H);
+    failures += report_solver("dlt", "batch deg.", st,
+                              st==1 && isnan(R[0]) && err <= 1e-9);
+    return failures;
+}
+
+/// Compare the output for default parameters to an expected result
+static int check_expected(const double *in, int w, int h, int c,
+                          const char* fileRef) {
+    int wr, hr, cr;
+    double* expected = iio_read_image_double_split(fileRef, &wr, &hr, &cr);
+    if(wr!=w || hr!=h || cr!=c) {
+        fprintf(stderr, "Expected image %s of wrong size\n", fileRef);
+        free(expected);
+        return 1;
+    }
+    double eps=1e-6, H[9] = {1, 0, 0.5, 0, 1, 0, 0, 0, 1};
+    double *out = malloc(w*h*c*sizeof*out);
+    warp_reference(out, 0, 0, w, h, in, w, h, c,
+                   MAX_TABULATED_ORDER, BOUNDARY_HSYMMETRIC, eps, H);
+    double maxErr, rms;
+    compare(&maxErr, &rms, out, expected, w*h*c);
+    int ok = (maxErr <= 255*eps);
+    printf("expected   %-8s %2d %-10s 1e-6 H0 %10.3g %10.3g %s\n",
+           "ref", MAX_TABULATED_ORDER, "hsymmetric", maxErr, rms,
+           ok? "ok": "FAIL");
+    free(out);
+    free(expected);
+    return !ok;
+}
+
+/// Check accuracy of all interpolation paths with respect to reference
+int main(int argc, char *argv[]) {
+    if(argc > 3) {
+        fprintf(stderr, "Usage: %s [image [expected]]\n", argv[0]);
+        fprintf(stderr, "image   : input image, in addition to synthetic "
+                        "ones\n");
+        fprintf(stderr, "expected: image shifted by 0.5 pixel horizontally "
+                        "with default parameters\n");
+        return EXIT_FAILURE;
+    }
+
+    int failures = 0;
+    printf("image      path    ord boundary   eps  H "
+           "    maxErr        rms speedup\n");
+    const char* synthNames[] = {"noise", "ramp", "impulse", "checker"};
+    for(int i=0; i<4; i++) {
+        int w=128, h=96;
+        double* im = synthetic_image(i, w, h);
+        failures += check_image(synthNames[i], im, w, h, 1);
+        if(i == 0) {
+            failures += check_mesh(im, w, h);
+            failures += check_grid_mismatch(im, w, h);
+            failures += check_shared_replan(im, w, h);
+            failures += check_scheduler(im, w, h);
+        }
+        free(im);
+    }
+
+    failures += check_control();
+    failures += check_rotation_angles();
+    failures += check_solvers();
+
+    if(argc > 1) {
+        int w, h, c;
+        double *in = iio_read_image_double_split(argv[1], &w, &h, &c);
+        if(! in) {
+            fprintf(stderr, "Unable to read image %s\n", argv[1]);
+            return EXIT_FAILURE;
+        }
+        if(argc > 2)
+            failures += check_expected(in, w, h, c, argv[2]);
+        failures += check_image("image", in, w, h, c);
+        free(in);
+    }
+
+    splinter_async_shutdown();
+    printf("%d failure(s)\n", failures);
+    return (failures==0)? EXIT_SUCCESS: EXIT_FAILURE;
+}
@@ -0,0 +1,88 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_config.c
+ * @brief Selection of interpolation parameters from measured cost and error
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "splinter.h"
+
+/// Relative difference of errors below which they are considered equal
+#define ERROR_TOLERANCE 0.01
+
+/// Whether the error of configuration \a c was measured (not NaN, nor negative)
+static int measured(const splinter_config_t* c) {
+    return c->error >= 0;
+}
+
+/// \brief Tell whether configuration \a a dominates \a b: not slower, not less
+/// accurate and strictly better in one of the criteria. Errors differing by
+/// less than ERROR_TOLERANCE (relative) are considered equal. Only measured
+/// configurations are compared.
+static int dominates(const splinter_config_t* a, const splinter_config_t* b) {
+    double tol = 1+ERROR_TOLERANCE;
+    return measured(a) && measured(b) &&
+        a->seconds <= b->seconds && a->error <= b->error*tol &&
+        (a->seconds < b->seconds || a->error*tol < b->error);
+}
+
+/// \brief Extract the Pareto front of configurations for (time, error).
+/// \param[out] front indices of non-dominated configurations, by increasing
+/// time (array of size at least \a n).
+/// \param configs measured configurations.
+/// \param n number of configurations.
+/// \return the number of configurations in the front, which excludes those
+/// whose error was not measured.
+int splinter_pareto_front(int* front, const splinter_config_t* configs, int n) {
+    int nFront = 0;
+    for(int i=0; i<n; i++) {
+        if(! measured(configs+i))
+            continue;
+        int j;
+        for(j=0; j<n; j++)
+            if(dominates(configs+j, configs+i))
+                break;
+        if(j < n)
+            continue;
+        // Insertion by increasing time
+        for(j=nFront; j>0 && configs[front[j-1]].seconds>configs[i].seconds;
+            j--)
+            front[j] = front[j-1];
+        front[j] = i;
+        ++nFront;
+    }
+    return nFront;
+}
+
+/// \brief Cheapest configuration whose error is at most \a maxError.
+/// \param configs measured configurations, for example by splinter_pareto.
+/// \param n number of configurations.
+/// \param maxError target error.
+/// \return the index of the configuration, -1 if none meets the target.
+/// Configurations whose error was not measured are ignored.
+int splinter_cheapest_config(const splinter_config_t* configs, int n,
+                             double maxError) {
+    int best = -1;
+    for(int i=0; i<n; i++)
+        if(measured(configs+i) && configs[i].error <= maxError &&
+           (best < 0 || configs[i].seconds < configs[best].seconds))
+            best = i;
+    return best;
+}
@@ -0,0 +1,85 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_cxx_check.cpp
+ * @brief Check of the C++ wrapper against the C library
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/// \file splinter_cxx_check.cpp
+/// Compile the C++17 header and compare spl::Interpolator, for all tabulated
+/// orders, to the C function splinter at points inside and near the border of
+/// the image. Return a failure status on mismatch.
+
+#include "splinter.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+/// Compare Interpolator<Order> to splinter for image \a im. Return the number
+/// of failures (0 or 1).
+template <int Order>
+static int check_order(const std::vector<float>& im, int w, int h, int c) {
+    spl::Plan<float> owner(im, w, h, c, Order, BOUNDARY_HSYMMETRIC, 1e-9);
+    spl::Plan<float> plan(std::move(owner)); // Move-only
+    spl::Interpolator<Order, float> interp(plan);
+    std::vector<double> a(c), b(c), xy, batch;
+    double maxErr = 0;
+    for(double y=-0.5; y<h; y+=0.37)
+        for(double x=-0.5; x<w; x+=0.41) {
+            interp(a, x, y);
+            ::splinter(b.data(), x, y, plan.get());
+            xy.push_back(x);
+            xy.push_back(y);
+            for(int l=0; l<c; l++)
+                maxErr = std::max(maxErr, std::fabs(a[l]-b[l]));
+        }
+    batch.resize(xy.size()/2*c);
+    plan.batch(batch, xy);
+    for(std::size_t i=0; i<xy.size()/2; i++) {
+        ::splinter(b.data(), xy[2*i], xy[2*i+1], plan.get());
+        for(int l=0; l<c; l++)
+            maxErr = std::max(maxErr, std::fabs(batch[i*c+l]-b[l]));
+    }
+    bool ok = (maxErr <= 1e-9);
+    std::printf("Interpolator<%2d> %10.3g %s\n", Order, maxErr,
+                ok? "ok": "FAIL");
+    return !ok;
+}
+
+/// Check all orders of the sequence
+template <int... Orders>
+static int check_orders(const std::vector<float>& im, int w, int h, int c,
+                        std::integer_sequence<int, Orders...>) {
+    return (check_order<Orders>(im, w, h, c) + ...);
+}
+
+int main() {
+    const int w=40, h=30, c=2;
+    std::vector<float> im(w*h*c);
+    std::srand(1);
+    for(float& v: im)
+        v = (float)(std::rand()/(double)RAND_MAX);
+    using orders = std::make_integer_sequence<int,MAX_TABULATED_ORDER+1>;
+    int failures = check_orders(im, w, h, c, orders());
+    std::printf("%d failure(s)\n", failures);
+    return (failures==0)? EXIT_SUCCESS: EXIT_FAILURE;
+}
@@ -0,0 +1,135 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_mesh.c
+ * @brief Mesh warps: piecewise homographies on a grid of cells
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// \file splinter_mesh.c
+/// The output area is cut in a grid of nx x ny cells, each one with its own
+/// homography, as in panorama stitching or rolling-shutter correction. Cell
+/// (a,b) covers the output pixels (i,j) such that a*wo/nx <= i < (a+1)*wo/nx
+/// and b*ho/ny <= j < (b+1)*ho/ny, so that each pixel is computed exactly
+/// once. All cells share the same plan. Bands of rows are distributed among
+/// threads, see \ref splinter_plan_with_nthreads.
+
+#include "splinter_mesh.h"
+#include "homography_tools.h"
+#include <stdlib.h>
+
+/// Arguments of the parallel tasks of mesh warp
+typedef struct {
+    void* out; ///< output image
+    splinter_layout_t layout; ///< layout of output image
+    double x0, y0; ///< top-left corner of output area
+    int wout, hout; ///< size of output
+    splinter_plan_t plan; ///< interpolation plan
+    int nx, ny; ///< number of cells horizontally and vertically
+    const double* iH; ///< inverse homographies of cells, in row order
+} mesh_args_t;
+
+/// First pixel of cell \a k among \a n cells covering \a size pixels
+static int cell_start(int k, int n, int size) {
+    return (int)(((long long)k*size + n-1) / n);
+}
+
+/// Interpolate rows [j0,j1) of output, cell by cell
+static void mesh_rows(void* args, int j0, int j1) {
+    const mesh_args_t* a = args;
+    for(int b=0; b<a->ny; b++) {
+        int r0 = cell_start(b, a->ny, a->hout);
+        int r1 = cell_start(b+1, a->ny, a->hout);
+        if(r0 < j0) r0 = j0;
+        if(r1 > j1) r1 = j1;
+        for(int k=0; k<a->nx && r0<r1; k++)
+            splinter_homography_tile(a->out, a->layout, a->x0, a->y0,
+                                     cell_start(k, a->nx, a->wout), r0,
+                                     cell_start(k+1, a->nx, a->wout), r1,
+                                     a->plan, a->iH + 9*(b*a->nx+k));
+    }
+}
+
+/// Mesh warp with inverse homographies \a iH
+static SplinterStatus mesh_warp(void *out, splinter_layout_t layout,
+                                double x0, double y0, int wout, int hout,
+                                splinter_plan_t plan, int nx, int ny,
+                                const double* iH,
+                                const splinter_control_t* ctl) {
+    mesh_args_t args = {out, layout, x0, y0, wout, hout, plan, nx, ny, iH};
+    return splinter_parallel_for_control(hout, mesh_rows, &args, ctl);
+}
+
+/// \brief Apply a homography per cell of a grid, see
+/// \ref splinter_homography_control.
+/// \param nx,ny number of cells horizontally and vertically, positive
+/// \param H homographies of cells, 9 values each, in row order of cells
+/// \return SPLINTER_OK if the output is complete, SPLINTER_INVALID if there is
+/// no cell.
+SplinterStatus splinter_mesh_homographies(void *out, splinter_layout_t layout,
+                                          double x0, double y0,
+                                          int wout, int hout,
+                                          splinter_plan_t plan,
+                                          int nx, int ny, const double* H,
+                                          const splinter_control_t* ctl) {
+    if(nx <= 0 || ny <= 0)
+        return SPLINTER_INVALID;
+    double* iH = malloc(9*nx*ny*sizeof*iH);
+    for(int k=0; k<nx*ny; k++)
+        invert_homography(iH+9*k, H+9*k);
+    SplinterStatus status = mesh_warp(out, layout, x0, y0, wout, hout, plan,
+                                      nx, ny, iH, ctl);
+    free(iH);
+    return status;
+}
+
+/// \brief Warp defined by the input positions of the vertices of a grid.
+/// \details Vertex (a,b) of the grid is at output position
+/// (x0+a*wo/nx, y0+b*ho/ny). In each cell, the homography sending its four
+/// vertices to their input positions is applied. Adjacent cells share the
+/// positions of their common vertices, so that the warp is continuous at
+/// their vertices and maps their common edge to the same segment.
+/// \param nx,ny number of cells horizontally and vertically, positive
+/// \param xy input coordinates of the (nx+1)*(ny+1) vertices, in row order
+/// \return SPLINTER_OK if the output is complete, SPLINTER_INVALID if there is
+/// no cell.
+SplinterStatus splinter_mesh_vertices(void *out, splinter_layout_t layout,
+                                      double x0, double y0,
+                                      int wout, int hout,
+                                      splinter_plan_t plan,
+                                      int nx, int ny, const double* xy,
+                                      const splinter_control_t* ctl) {
+    if(nx <= 0 || ny <= 0)
+        return SPLINTER_INVALID;
+    double* iH = malloc(9*nx*ny*sizeof*iH);
+    for(int b=0; b<ny; b++)
+        for(int a=0; a<nx; a++) {
+            double X0 = x0+(double)a*wout/nx, X1 = x0+(double)(a+1)*wout/nx;
+            double Y0 = y0+(double)b*hout/ny, Y1 = y0+(double)(b+1)*hout/ny;
+            double p[4][2] = {{X0,Y0}, {X0,Y1}, {X1,Y1}, {X1,Y0}};
+            const double* v = xy + 2*(b*(nx+1)+a);
+            homography_from_4corresp(p[0], p[1], p[2], p[3],
+                                     v, v+2*(nx+1), v+2*(nx+1)+2, v+2,
+                                     (double(*)[3])(iH+9*(b*nx+a)));
+        }
+    SplinterStatus status = mesh_warp(out, layout, x0, y0, wout, hout, plan,
+                                      nx, ny, iH, ctl);
+    free(iH);
+    return status;
+}
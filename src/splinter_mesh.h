@@ -0,0 +1,42 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_mesh.h
+ * @brief Mesh warps: piecewise homographies on a grid of cells
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPLINTERMESH_H
+#define SPLINTERMESH_H
+
+#include "splinter_transform.h"
+
+SplinterStatus splinter_mesh_homographies(void *out, splinter_layout_t layout,
+                                          double x0, double y0,
+                                          int wo, int ho,
+                                          splinter_plan_t plan,
+                                          int nx, int ny, const double* homo,
+                                          const splinter_control_t* ctl);
+SplinterStatus splinter_mesh_vertices(void *out, splinter_layout_t layout,
+                                      double x0, double y0, int wo, int ho,
+                                      splinter_plan_t plan,
+                                      int nx, int ny, const double* xy,
+                                      const splinter_control_t* ctl);
+
+#endif
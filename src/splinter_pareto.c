@@ -0,0 +1,180 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_pareto.c
+ * @brief Accuracy/cost trade-off of interpolation parameters
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "splinter_transform.h"
+#include "homography_tools.h"
+#include "xmtime.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define NWAVES 8 ///< Number of plane waves in test image
+#define MAX_FREQ 0.2 ///< Maximum frequency of waves (cycles/pixel)
+#define MARGIN 16 ///< Distance to boundary of pixels where error is measured
+
+static const int Precisions[] = {2, 3, 4, 6, 8, 10}; ///< eps=10^-p
+
+/// Test image: sum of plane waves, known at any point.
+typedef struct {
+    double u[NWAVES], v[NWAVES], phi[NWAVES]; ///< frequencies and phases
+} waves_t;
+
+/// Value of test image at (x,y)
+static double waves_eval(const waves_t* f, double x, double y) {
+    double v = 0;
+    for(int k=0; k<NWAVES; k++)
+        v += cos(2*M_PI*(f->u[k]*x + f->v[k]*y) + f->phi[k]);
+    return v/NWAVES;
+}
+
+/// Random waves and sampled image
+static double* waves_image(waves_t* f, int w, int h) {
+    srand(1);
+    for(int k=0; k<NWAVES; k++) {
+        f->u[k] = MAX_FREQ*(2*rand()/(double)RAND_MAX-1);
+        f->v[k] = MAX_FREQ*(2*rand()/(double)RAND_MAX-1);
+        f->phi[k] = 2*M_PI*rand()/(double)RAND_MAX;
+    }
+    double* im = malloc(w*h*sizeof*im);
+    for(int y=0; y<h; y++)
+        for(int x=0; x<w; x++)
+            im[x+y*w] = waves_eval(f, x, y);
+    return im;
+}
+
+/// RMS error with respect to exact values, measured at output pixels whose
+/// antecedent is at least MARGIN pixels inside the image. Return NaN if none.
+static double rms_error(const double* out, const waves_t* f, int w, int h,
+                        const double H[9]) {
+    double iH[9], p[2], q[2], e = 0;
+    invert_homography(iH, H);
+    int n = 0;
+    for(int j=0; j<h; j++)
+        for(int i=0; i<w; i++) {
+            p[0] = i; p[1] = j;
+            apply_homography(q, p, iH);
+            if(q[0] < MARGIN || q[0] > w-1-MARGIN ||
+               q[1] < MARGIN || q[1] > h-1-MARGIN)
+                continue;
+            double d = out[i+j*w] - waves_eval(f, q[0], q[1]);
+            e += d*d;
+            ++n;
+        }
+    return (n>0)? sqrt(e/n): NAN;
+}
+
+/// Measure time and error of configuration \a cfg
+static void measure(splinter_config_t* cfg, const double* in, double* out,
+                    const waves_t* f, int w, int h, const double H[9]) {
+    int n = 0;
+    unsigned long t0 = xmtime(), t;
+    do {
+        splinter_homography(out, in, w, h, 1, cfg->order, BOUNDARY_HSYMMETRIC,
+                            cfg->eps, cfg->larger, H);
+        ++n;
+    } while((t=xmtime()-t0) < 100);
+    cfg->seconds = t/(1000.0*n);
+    cfg->error = rms_error(out, f, w, h, H);
+}
+
+/// Print a configuration
+static void print_config(const splinter_config_t* c) {
+    printf("%2d %8.0e %d %9.4f %10.3e\n",
+           c->order, c->eps, c->larger, c->seconds, c->error);
+}
+
+/// Measure time and error of all (order, eps, larger) configurations and
+/// display the Pareto front
+int main(int argc, char *argv[]) {
+    if(argc != 4 && argc != 5) {
+        fprintf(stderr, "Usage: %s w h class [error]\n", argv[0]);
+        fprintf(stderr, "w h  : image size\n");
+        fprintf(stderr, "class: homography (translation, rotation, "
+                        "perspective)\n");
+        fprintf(stderr, "error: target RMS error (relative to amplitude)\n");
+        return EXIT_FAILURE;
+    }
+    int w = atoi(argv[1]), h = atoi(argv[2]);
+    const char* names[] = {"translation", "rotation", "perspective"};
+    int type;
+    for(type=0; type<3; type++)
+        if(0 == strncmp(argv[3], names[type], strlen(argv[3])))
+            break;
+    if(w <= 2*MARGIN || h <= 2*MARGIN || type == 3) {
+        fprintf(stderr, "Image must be larger than %dx%d, class among "
+                "translation, rotation, perspective\n", 2*MARGIN, 2*MARGIN);
+        return EXIT_FAILURE;
+    }
+    double H[9];
+    homography_of_class(H, type, w, h);
+
+    waves_t f;
+    double* in = waves_image(&f, w, h);
+    double* out = malloc(w*h*sizeof*out);
+
+    int nPrec = sizeof(Precisions)/sizeof(*Precisions);
+    int nMax = (MAX_TABULATED_ORDER+1)*nPrec*2, n=0;
+    splinter_config_t* configs = malloc(nMax*sizeof*configs);
+    printf("# All configurations\n");
+    printf("order eps larger time(s) RMS-error\n");
+    for(int order=0; order<=MAX_TABULATED_ORDER; order++)
+        for(int p=0; p<nPrec; p++)
+            for(int larger=0; larger<=1; larger++) {
+                if(order < 2 && (p > 0 || larger)) // No prefiltering
+                    continue;
+                splinter_config_t* c = configs + n++;
+                c->order = order;
+                c->eps = pow(10, -Precisions[p]);
+                c->larger = larger;
+                measure(c, in, out, &f, w, h, H);
+                print_config(c);
+            }
+
+    int* front = malloc(n*sizeof*front);
+    int nFront = splinter_pareto_front(front, configs, n);
+    printf("# Pareto front\n");
+    for(int i=0; i<nFront; i++)
+        print_config(configs+front[i]);
+
+    if(argc > 4) {
+        double target = atof(argv[4]);
+        int i = splinter_cheapest_config(configs, n, target);
+        printf("# Cheapest configuration for error %g\n", target);
+        if(i < 0)
+            printf("none\n");
+        else
+            print_config(configs+i);
+    }
+
+    free(front);
+    free(configs);
+    free(in);
+    free(out);
+    return EXIT_SUCCESS;
+}
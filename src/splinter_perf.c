@@ -0,0 +1,304 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_perf.c
+ * @brief Microbenchmarks of prefiltering and kernel evaluation stages
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE // syscall, clock_gettime
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// The internal stages are static functions of the library: include the
+// sources to benchmark them in isolation.
+#include "bspline.c"
+#include "splinter.c"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/// Hardware counters read for each stage
+enum {CYCLES, INSTRUCTIONS, CACHE_MISSES, TLB_MISSES, NCOUNTERS};
+static const char* CounterNames[NCOUNTERS] = {"cycles", "instr",
+                                              "LLC-miss", "dTLB-miss"};
+
+/// Counters of a stage. A file descriptor -1 means not available.
+typedef struct {
+    int fd[NCOUNTERS]; ///< perf_event file descriptors
+    long long value[NCOUNTERS]; ///< counts of last measurement
+    struct timespec t0; ///< start time
+    double seconds; ///< duration of last measurement
+} counters_t;
+
+/// Open the hardware counters, those unavailable are silently ignored.
+static void counters_open(counters_t* c) {
+    for(int i=0; i<NCOUNTERS; i++)
+        c->fd[i] = -1;
+#ifdef __linux__
+    static const unsigned int type[NCOUNTERS] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+        PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE};
+    static const unsigned long long config[NCOUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+    for(int i=0; i<NCOUNTERS; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type[i];
+        attr.config = config[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        c->fd[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+}
+
+/// Close the hardware counters
+static void counters_close(counters_t* c) {
+#ifdef __linux__
+    for(int i=0; i<NCOUNTERS; i++)
+        if(c->fd[i] >= 0)
+            close(c->fd[i]);
+#else
+    (void)c;
+#endif
+}
+
+/// Start measurement
+static void counters_start(counters_t* c) {
+#ifdef __linux__
+    for(int i=0; i<NCOUNTERS; i++)
+        if(c->fd[i] >= 0) {
+            ioctl(c->fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(c->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &c->t0);
+}
+
+/// Stop measurement and read counters
+static void counters_stop(counters_t* c) {
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    c->seconds = (t1.tv_sec-c->t0.tv_sec) + 1e-9*(t1.tv_nsec-c->t0.tv_nsec);
+    for(int i=0; i<NCOUNTERS; i++) {
+        c->value[i] = -1;
+#ifdef __linux__
+        if(c->fd[i] >= 0) {
+            ioctl(c->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+            if(read(c->fd[i], &c->value[i], sizeof(long long)) !=
+               sizeof(long long))
+                c->value[i] = -1;
+        }
+#endif
+    }
+}
+
+/// Print the measurement of a stage, normalized per element. The bandwidth
+/// is estimated from the number of bytes accessed per element.
+static void report(const char* name, const counters_t* c,
+                   double nElem, double bytes) {
+    printf("%-22s %8.2f", name, 1e9*c->seconds/nElem);
+    for(int i=0; i<NCOUNTERS; i++)
+        if(c->value[i] >= 0)
+            printf(" %9.3f", c->value[i]/nElem);
+        else
+            printf(" %9s", "n/a");
+    if(c->value[CYCLES] > 0 && c->value[INSTRUCTIONS] >= 0)
+        printf(" %5.2f", c->value[INSTRUCTIONS]/(double)c->value[CYCLES]);
+    else
+        printf(" %5s", "n/a");
+    if(bytes > 0)
+        printf(" %7.2f\n", bytes*nElem/c->seconds*1e-9);
+    else
+        printf(" %7s\n", "-");
+}
+
+/// Fill image with random values
+static void fill_random(double* im, int n) {
+    srand(1);
+    for(int i=0; i<n; i++)
+        im[i] = rand()/(double)RAND_MAX;
+}
+
+/// Exponential filters on columns (strided) and rows (contiguous)
+static void bench_expfilter(counters_t* cnt, double* im, int w, int h,
+                            const prefilter_t* p, const int* trunc) {
+    double n = (double)w*h*p->nPoles;
+    fill_random(im, w*h);
+    counters_start(cnt);
+    for(int x=0; x<w; x++)
+        for(int k=0; k<p->nPoles; k++)
+            expFilter(im+x, w, h, BOUNDARY_HSYMMETRIC, p->poles[k], trunc[k]);
+    counters_stop(cnt);
+    report("expFilter columns", cnt, n, 4*sizeof(double));
+
+    fill_random(im, w*h);
+    counters_start(cnt);
+    for(int y=0; y<h; y++)
+        for(int k=0; k<p->nPoles; k++)
+            expFilter(im+w*y, 1, w, BOUNDARY_HSYMMETRIC,p->poles[k],trunc[k]);
+    counters_stop(cnt);
+    report("expFilter rows", cnt, n, 4*sizeof(double));
+
+    fill_random(im, w*h);
+    counters_start(cnt);
+    for(int x=0; x<w; x++)
+        for(int k=0; k<p->nPoles; k++)
+            expFilterExt(im+x, w, h, p->poles[k], trunc[k]);
+    counters_stop(cnt);
+    report("expFilterExt columns", cnt, n, 4*sizeof(double));
+
+    fill_random(im, w*h);
+    counters_start(cnt);
+    for(int y=0; y<h; y++)
+        for(int k=0; k<p->nPoles; k++)
+            expFilterExt(im+w*y, 1, w, p->poles[k], trunc[k]);
+    counters_stop(cnt);
+    report("expFilterExt rows", cnt, n, 4*sizeof(double));
+}
+
+/// Evaluation of a kernel function at \a n points covering its support
+static void bench_kernel(counters_t* cnt, const char* name,
+                         const Bspline* s, int n) {
+    volatile double sink = 0;
+    double sum = 0, step = 2*s->radius/n;
+    counters_start(cnt);
+    for(int i=0; i<n; i++)
+        sum += s->eval(-s->radius + i*step, s);
+    counters_stop(cnt);
+    sink = sum;
+    (void)sink;
+    report(name, cnt, n, 0);
+}
+
+/// Interpolation at random points: kernel evaluation and tap loop
+static void bench_splinter(counters_t* cnt, double* im, int w, int h,
+                           int order, int n) {
+    fill_random(im, w*h);
+    splinter_plan_t plan = splinter_plan(im, w, h, 1, order,
+                                         BOUNDARY_HSYMMETRIC, 1e-6, 0);
+    double* pts = malloc(2*n*sizeof*pts);
+    for(int i=0; i<2*n; i+=2) {
+        pts[i+0] = rand()/(double)RAND_MAX*(w-1);
+        pts[i+1] = rand()/(double)RAND_MAX*(h-1);
+    }
+    int kWidth = (order==0)? 2: order+1;
+    volatile double sink = 0;
+    double v, sum = 0;
+
+    counters_start(cnt);
+    for(int i=0; i<2*n; i+=2) {
+        int x0 = ceil(pts[i]-plan.bspline->radius);
+        int y0 = ceil(pts[i+1]-plan.bspline->radius);
+        for(int k=0; k<kWidth; k++)
+            sum += plan.bspline->eval(pts[i]-(x0+k), plan.bspline) +
+                plan.bspline->eval(pts[i+1]-(y0+k), plan.bspline);
+    }
+    counters_stop(cnt);
+    report("splinter kernel", cnt, n, 0);
+
+    counters_start(cnt);
+    for(int i=0; i<2*n; i+=2) {
+        splinter(&v, pts[i], pts[i+1], plan);
+        sum += v;
+    }
+    counters_stop(cnt);
+    report("splinter kernel+taps", cnt, n, kWidth*kWidth*sizeof(double));
+    sink = sum;
+    (void)sink;
+
+    free(pts);
+    splinter_destroy_plan(plan);
+}
+
+/// Microbenchmarks of the stages of prefiltering and interpolation
+int main(int argc, char *argv[]) {
+    if(argc > 3) {
+        fprintf(stderr, "Usage: %s [size [order]]\n", argv[0]);
+        fprintf(stderr, "size : image is size x size (default 2048)\n");
+        fprintf(stderr, "order: spline order (default %d)\n",
+                MAX_TABULATED_ORDER);
+        return EXIT_FAILURE;
+    }
+    int size = (argc>1)? atoi(argv[1]): 2048;
+    int order = (argc>2)? atoi(argv[2]): MAX_TABULATED_ORDER;
+    if(size <= 0 || order < 2 || order > MAX_TABULATED_ORDER) {
+        fprintf(stderr, "Size must be positive and order in [2,%d]\n",
+                MAX_TABULATED_ORDER);
+        return EXIT_FAILURE;
+    }
+
+    counters_t cnt;
+    counters_open(&cnt);
+    int nAvail = 0;
+    for(int i=0; i<NCOUNTERS; i++)
+        nAvail += (cnt.fd[i] >= 0);
+    if(nAvail < NCOUNTERS)
+        fprintf(stderr, "Warning: %d hardware counter(s) unavailable "
+                "(check /proc/sys/kernel/perf_event_paranoid)\n",
+                NCOUNTERS-nAvail);
+
+    printf("%-22s %8s", "stage (per element)", "ns");
+    for(int i=0; i<NCOUNTERS; i++)
+        printf(" %9s", CounterNames[i]);
+    printf(" %5s %7s\n", "IPC", "GB/s");
+
+    double* im = malloc((size_t)size*size*sizeof*im);
+    prefilter_t p;
+    Bspline s;
+    get_bspline(order, &p, &s);
+    int* trunc = malloc(p.nPoles*sizeof*trunc);
+    compute_truncation(trunc, p.poles, p.nPoles, 1e-6);
+    bench_expfilter(&cnt, im, size, size, &p, trunc);
+    free(trunc);
+
+    char name[32];
+    for(int n=0; n<=MAX_TABULATED_ORDER; n++) {
+        prefilter_t pn;
+        Bspline sn;
+        get_bspline(n, &pn, &sn);
+        sprintf(name, "BSpline%d", n);
+        bench_kernel(&cnt, name, &sn, 10000000);
+    }
+    // Generic evaluation, used beyond tabulated orders
+    s.C = malloc(((order+1)*s.tn+floor(s.radius)+1)*sizeof*s.C);
+    compute_bspline_poly(s.C, order);
+    s.eval = bsplineEval;
+    sprintf(name, "bsplineEval(%d)", order);
+    bench_kernel(&cnt, name, &s, 10000000);
+    free(s.C);
+
+    bench_splinter(&cnt, im, size, size, order, 1000000);
+
+    free(im);
+    counters_close(&cnt);
+    return EXIT_SUCCESS;
+}
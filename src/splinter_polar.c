@@ -0,0 +1,123 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_polar.c
+ * @brief Polar and log-polar resampling with precomputed taps
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/// \file splinter_polar.c
+/// Polar and log-polar representations, used for rotation and scale
+/// invariant matching, sample the image on rings about a center. Output pixel
+/// (i,j) is at angle 2*pi*i/nAngles on ring j. The coordinates of the samples
+/// are built from tables of cosines and sines per angle and radii per ring,
+/// and their interpolation taps are precomputed once (see
+/// \ref splinter_grid_create), so that all images of the same size reuse
+/// them. Rings are distributed among threads.
+
+#include "splinter_polar.h"
+#include <math.h>
+#include <stdlib.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/// Polar sampling pattern
+struct splinter_polar_s {
+    int nRings, nAngles; ///< dimensions of output
+    splinter_grid_t* grid; ///< taps of samples, ring after ring
+};
+
+/// \brief Create the sampling pattern of a polar or log-polar image.
+/// \details Ring j has radius rMin+(rMax-rMin)*j/(nRings-1), or
+/// rMin*(rMax/rMin)^(j/(nRings-1)) if \a logPolar is set (then rMin>0). The
+/// pattern is valid for all plans created with the same parameters as
+/// \a plan, see \ref splinter_grid_create.
+/// \param cx,cy center of rings in the input image
+/// \param nRings,nAngles number of rings and of samples per ring
+splinter_polar_t* splinter_polar_create(splinter_plan_t plan,
+                                        double cx, double cy,
+                                        double rMin, double rMax,
+                                        int nRings, int nAngles, int logPolar){
+    double* cosine = malloc(nAngles*sizeof*cosine);
+    double* sine = malloc(nAngles*sizeof*sine);
+    for(int i=0; i<nAngles; i++) {
+        cosine[i] = cos(2*M_PI*i/nAngles);
+        sine[i] = sin(2*M_PI*i/nAngles);
+    }
+    double* xy = malloc(2*(size_t)nRings*nAngles*sizeof*xy);
+    for(int j=0; j<nRings; j++) {
+        double t = (nRings>1)? (double)j/(nRings-1): 0;
+        double r = logPolar? rMin*pow(rMax/rMin, t): rMin+(rMax-rMin)*t;
+        double* p = xy + 2*(size_t)j*nAngles;
+        for(int i=0; i<nAngles; i++) {
+            p[2*i] = cx + r*cosine[i];
+            p[2*i+1] = cy + r*sine[i];
+        }
+    }
+    splinter_polar_t* polar = malloc(sizeof*polar);
+    polar->nRings = nRings;
+    polar->nAngles = nAngles;
+    polar->grid = splinter_grid_create(xy, nRings*nAngles, plan);
+    free(xy);
+    free(sine);
+    free(cosine);
+    return polar;
+}
+
+/// \brief Dispose of the sampling pattern.
+void splinter_polar_destroy(splinter_polar_t* polar) {
+    splinter_grid_destroy(polar->grid);
+    free(polar);
+}
+
+/// Arguments of the parallel tasks of polar resampling
+typedef struct {
+    void* out; ///< output image
+    splinter_layout_t layout; ///< layout of output image
+    const splinter_polar_t* polar; ///< sampling pattern
+    splinter_plan_t plan; ///< interpolation plan
+} polar_args_t;
+
+/// Interpolate rings [j0,j1)
+static void polar_rings(void* args, int j0, int j1) {
+    const polar_args_t* a = args;
+    int n = a->polar->nAngles, c = a->plan.c;
+    double* v = malloc(n*c*sizeof*v);
+    for(int j=j0; j<j1; j++) {
+        splinter_grid(v, a->polar->grid, a->plan, j*n, (j+1)*n);
+        for(int i=0; i<n; i++)
+            splinter_store_pixel(a->out, a->layout, i, j, v+i*c, c);
+    }
+    free(v);
+}
+
+/// \brief Polar or log-polar resampling of the image of \a plan.
+/// \details The output image has nAngles columns and nRings rows.
+/// \return SPLINTER_OK if the output is complete.
+SplinterStatus splinter_polar(void *out, splinter_layout_t layout,
+                              const splinter_polar_t* polar,
+                              splinter_plan_t plan,
+                              const splinter_control_t* ctl) {
+    polar_args_t args = {out, layout, polar, plan};
+    return splinter_parallel_for_control(polar->nRings, polar_rings, &args,
+                                         ctl);
+}
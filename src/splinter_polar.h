@@ -0,0 +1,44 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_polar.h
+ * @brief Polar and log-polar resampling with precomputed taps
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SPLINTERPOLAR_H
+#define SPLINTERPOLAR_H
+
+#include "splinter_transform.h"
+
+/// Opaque polar sampling pattern
+typedef struct splinter_polar_s splinter_polar_t;
+
+splinter_polar_t* splinter_polar_create(splinter_plan_t plan,
+                                        double cx, double cy,
+                                        double rMin, double rMax,
+                                        int nRings, int nAngles, int logPolar);
+void splinter_polar_destroy(splinter_polar_t* polar);
+SplinterStatus splinter_polar(void *out, splinter_layout_t layout,
+                              const splinter_polar_t* polar,
+                              splinter_plan_t plan,
+                              const splinter_control_t* ctl);
+
+#endif
@@ -0,0 +1,226 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_preview.c
+ * @brief Progressive transforms: low-order draft, then refinement
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// \file splinter_preview.c
+/// A draft of the transform is computed at low order (1 or 3: cheap or no
+/// prefiltering, few taps), while a task of the scheduler prefilters at the
+/// requested order. The last of the two to finish submits the task that
+/// overwrites the draft with the final transform, band by band, so that no
+/// task waits for another.
+
+#include "splinter_preview.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+/// State of a progressive transform
+struct splinter_preview_s {
+    void* out; ///< output image
+    splinter_layout_t outLayout; ///< layout of output image
+    double x0, y0; ///< top-left corner of output area
+    int wout, hout; ///< size of output
+    const void* in; ///< input image
+    splinter_layout_t layout; ///< layout of input image
+    int w, h, c; ///< input dimensions
+    int order; ///< final order
+    BoundaryExt boundary; ///< boundary extension
+    double eps; ///< precision of prefiltering
+    int larger; ///< prefiltering in larger domain
+    double H[9]; ///< homography
+    splinter_preview_fn callback; ///< called at end of refinement
+    void* user; ///< argument of callback
+
+    splinter_plan_t plan; ///< plan at final order
+    void* tasks[2]; ///< handles of prefiltering and transform tasks
+    pthread_mutex_t mutex; ///< lock of the following members
+    pthread_cond_t cond; ///< signaled when refinement is done
+    int draftDone; ///< draft is written, refinement may overwrite it
+    int prefiltered; ///< plan at final order is computed
+    int waited; ///< tasks were passed to splinter_wait
+    int done; ///< refinement is over
+    SplinterStatus status; ///< status of refinement
+    volatile int cancel; ///< set to cancel refinement
+};
+
+/// End of refinement
+static void finish(splinter_preview_t* p, SplinterStatus status) {
+    pthread_mutex_lock(&p->mutex);
+    p->done = 1;
+    p->status = status;
+    pthread_cond_broadcast(&p->cond);
+    pthread_mutex_unlock(&p->mutex);
+    if(p->callback)
+        p->callback(status, p->user);
+}
+
+/// Task overwriting the draft with the final transform
+static void transform(void* arg, int begin, int end) {
+    (void)begin; (void)end;
+    splinter_preview_t* p = arg;
+    splinter_control_t ctl = {&p->cancel, 0};
+    SplinterStatus status =
+        splinter_homography_control(p->out, p->outLayout, p->x0, p->y0,
+                                    p->wout, p->hout, p->plan, p->H, &ctl);
+    splinter_destroy_plan(p->plan);
+    finish(p, status);
+}
+
+/// Submit the transform, once both the draft and the plan are ready
+static void submit_transform(splinter_preview_t* p) {
+    if(p->status != SPLINTER_OK) {
+        splinter_destroy_plan(p->plan);
+        finish(p, p->status);
+    } else
+        p->tasks[1] = splinter_submit(transform, p, 0, 1);
+}
+
+/// Task prefiltering at final order
+static void prefilter(void* arg, int begin, int end) {
+    (void)begin; (void)end;
+    splinter_preview_t* p = arg;
+    splinter_control_t ctl = {&p->cancel, 0};
+    SplinterStatus status;
+    splinter_plan_t plan = splinter_plan_control(p->in, p->layout,
+                                                 p->w, p->h, p->c, p->order,
+                                                 p->boundary, p->eps, p->larger,
+                                                 &ctl, &status);
+    pthread_mutex_lock(&p->mutex);
+    p->plan = plan;
+    p->status = status;
+    p->prefiltered = 1;
+    int last = p->draftDone;
+    pthread_mutex_unlock(&p->mutex);
+    if(last)
+        submit_transform(p);
+}
+
+/// \brief Progressive homography transform.
+/// \details The draft, at order \a draftOrder, is written in \a out before
+/// return. The transform at order \a order then overwrites it in background.
+/// The prefiltering at \a order is computed concurrently with the draft. The
+/// input and output images must remain valid until the refinement is over.
+/// \param callback function called by a task of the scheduler at the end of
+/// refinement (may be NULL). It must not wait for the preview.
+/// \param user argument of \a callback
+/// \return state of the transform, to be disposed of by
+/// \ref splinter_preview_release.
+splinter_preview_t* splinter_preview(void *out, splinter_layout_t outLayout,
+                                     double x0, double y0, int wout, int hout,
+                                     const void *in, splinter_layout_t layout,
+                                     int w, int h, int c,
+                                     int draftOrder, int order,
+                                     BoundaryExt boundary, double eps,
+                                     int larger, const double H[9],
+                                     splinter_preview_fn callback, void* user) {
+    splinter_preview_t* p = malloc(sizeof*p);
+    p->out = out;
+    p->outLayout = outLayout;
+    p->x0 = x0;
+    p->y0 = y0;
+    p->wout = wout;
+    p->hout = hout;
+    p->in = in;
+    p->layout = layout;
+    p->w = w;
+    p->h = h;
+    p->c = c;
+    p->order = order;
+    p->boundary = boundary;
+    p->eps = eps;
+    p->larger = larger;
+    for(int i=0; i<9; i++)
+        p->H[i] = H[i];
+    p->callback = callback;
+    p->user = user;
+    pthread_mutex_init(&p->mutex, NULL);
+    pthread_cond_init(&p->cond, NULL);
+    p->tasks[0] = p->tasks[1] = NULL;
+    p->draftDone = p->prefiltered = p->waited = p->done = 0;
+    p->status = SPLINTER_OK;
+    p->cancel = 0;
+    if(draftOrder > order)
+        draftOrder = order;
+    if(draftOrder < order)
+        p->tasks[0] = splinter_submit(prefilter, p, 0, 1);
+
+    // Draft, prefiltered in exact domain since precision is secondary
+    splinter_plan_t plan = splinter_plan_layout(in, layout, w, h, c,
+                                                draftOrder, boundary, eps, 0);
+    splinter_homography_layout(out, outLayout, x0, y0, wout, hout, plan, H);
+    splinter_destroy_plan(plan);
+
+    if(draftOrder == order) { // No refinement
+        finish(p, SPLINTER_OK);
+        return p;
+    }
+    pthread_mutex_lock(&p->mutex);
+    p->draftDone = 1;
+    int last = p->prefiltered;
+    pthread_mutex_unlock(&p->mutex);
+    if(last)
+        submit_transform(p);
+    return p;
+}
+
+/// \brief Whether the refinement is over.
+int splinter_preview_poll(splinter_preview_t* p) {
+    pthread_mutex_lock(&p->mutex);
+    int done = p->done;
+    pthread_mutex_unlock(&p->mutex);
+    return done;
+}
+
+/// \brief Wait for the end of refinement.
+/// \return SPLINTER_OK if the output is at final order, SPLINTER_CANCELLED if
+/// refinement was cancelled (the output is then partly refined).
+SplinterStatus splinter_preview_wait(splinter_preview_t* p) {
+    pthread_mutex_lock(&p->mutex);
+    if(! p->waited) { // The transform is submitted once prefiltering is over
+        p->waited = 1;
+        pthread_mutex_unlock(&p->mutex);
+        for(int i=0; i<2; i++)
+            if(p->tasks[i])
+                splinter_wait(p->tasks[i]);
+        pthread_mutex_lock(&p->mutex);
+    }
+    while(! p->done)
+        pthread_cond_wait(&p->cond, &p->mutex);
+    SplinterStatus status = p->status;
+    pthread_mutex_unlock(&p->mutex);
+    return status;
+}
+
+/// \brief Stop the refinement early, e.g., when the view changed.
+/// \details The refinement ends within one band of rows or columns, see
+/// \ref splinter_control_t.
+void splinter_preview_cancel(splinter_preview_t* p) {
+    p->cancel = 1;
+}
+
+/// \brief Wait for the end of refinement and dispose of the state.
+void splinter_preview_release(splinter_preview_t* p) {
+    splinter_preview_wait(p);
+    pthread_cond_destroy(&p->cond);
+    pthread_mutex_destroy(&p->mutex);
+    free(p);
+}
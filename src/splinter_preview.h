@@ -0,0 +1,49 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_preview.h
+ * @brief Progressive transforms: low-order draft, then refinement
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPLINTERPREVIEW_H
+#define SPLINTERPREVIEW_H
+
+#include "splinter_transform.h"
+
+/// Opaque state of a progressive transform
+typedef struct splinter_preview_s splinter_preview_t;
+
+/// Called by a task of the scheduler when refinement ends
+typedef void (*splinter_preview_fn)(SplinterStatus status, void* user);
+
+splinter_preview_t* splinter_preview(void *out, splinter_layout_t outLayout,
+                                     double x0, double y0, int wo, int ho,
+                                     const void *in, splinter_layout_t layout,
+                                     int w, int h, int c,
+                                     int draftOrder, int order,
+                                     BoundaryExt boundary, double eps,
+                                     int larger, const double homo[9],
+                                     splinter_preview_fn callback, void* user);
+int splinter_preview_poll(splinter_preview_t* p);
+SplinterStatus splinter_preview_wait(splinter_preview_t* p);
+void splinter_preview_cancel(splinter_preview_t* p);
+void splinter_preview_release(splinter_preview_t* p);
+
+#endif
@@ -0,0 +1,178 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_scaling.c
+ * @brief Thread scaling of plan creation and homography transform
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "splinter_transform.h"
+#include "homography_tools.h"
+#include "xmtime.h"
+
+static const char* TransformNames[] = {"translation", "rotation",
+                                       "perspective"};
+
+/// Times (s) of plan creation and transform
+typedef struct {
+    double plan, warp;
+} timing_t;
+
+/// Time plan creation and transform of a w x h image with \a nt threads.
+static timing_t run(const double* in, double* out, int w, int h, int order,
+                    int type, int nt) {
+    double H[9];
+    homography_of_class(H, type, w, h);
+    splinter_plan_with_nthreads(nt);
+    timing_t t;
+    unsigned long t0 = xmtime();
+    splinter_plan_t plan = splinter_plan(in, w, h, 1, order,
+                                         BOUNDARY_HSYMMETRIC, 1e-6, 0);
+    unsigned long t1 = xmtime();
+    splinter_homography_with_plan(out, 0, 0, w, h, plan, H);
+    unsigned long t2 = xmtime();
+    splinter_destroy_plan(plan);
+    t.plan = (t1-t0)/1000.0;
+    t.warp = (t2-t1)/1000.0;
+    return t;
+}
+
+/// Compulsory memory traffic (bytes per pixel) of plan: copy of input, then
+/// read and write of each pixel for causal and anti-causal passes of each
+/// pole in each direction.
+static double plan_bytes(int order) {
+    return sizeof(double)*(2 + 2*2*2*(order/2));
+}
+
+/// Image of given number of pixels, aspect ratio 4:3
+static double* make_image(double mp, int* w, int* h) {
+    *h = (int)sqrt(mp*1e6*3/4);
+    *w = (int)(mp*1e6 / *h);
+    double* im = malloc((size_t)*w**h*sizeof*im);
+    if(! im)
+        return NULL;
+    srand(1);
+    for(size_t i=0; i<(size_t)*w**h; i++)
+        im[i] = rand()/(double)RAND_MAX;
+    return im;
+}
+
+/// Powers of 2, then the maximum number of threads
+static int next_threads(int nt, int maxThreads) {
+    return (nt < maxThreads && 2*nt > maxThreads)? maxThreads: 2*nt;
+}
+
+/// Strong scaling: fixed image size, increasing number of threads
+static void strong_scaling(double mp, int maxThreads, int order) {
+    int w, h;
+    double* in = make_image(mp, &w, &h);
+    double* out = in? malloc((size_t)w*h*sizeof*out): NULL;
+    if(!in || !out) {
+        fprintf(stderr, "Not enough memory for %g MP\n", mp);
+        free(in);
+        free(out);
+        return;
+    }
+    for(int type=0; type<3; type++) {
+        timing_t t1 = {0, 0};
+        for(int nt=1; nt<=maxThreads; nt=next_threads(nt, maxThreads)) {
+            timing_t t = run(in, out, w, h, order, type, nt);
+            if(nt == 1)
+                t1 = t;
+            double np = (double)w*h;
+            printf("strong %7.1f %-11s %3d %8.3f %5.2f %6.2f %8.3f %5.2f "
+                   "%6.2f\n", mp, TransformNames[type], nt,
+                   t.plan, t1.plan/(nt*t.plan),
+                   plan_bytes(order)*np/t.plan*1e-9,
+                   t.warp, t1.warp/(nt*t.warp),
+                   2*sizeof(double)*np/t.warp*1e-9);
+        }
+    }
+    free(in);
+    free(out);
+}
+
+/// Weak scaling: image size proportional to the number of threads
+static void weak_scaling(double mp, int maxThreads, int order) {
+    for(int type=0; type<3; type++) {
+        timing_t t1 = {0, 0};
+        for(int nt=1; nt<=maxThreads; nt=next_threads(nt, maxThreads)) {
+            int w, h;
+            double* in = make_image(mp*nt, &w, &h);
+            double* out = in? malloc((size_t)w*h*sizeof*out): NULL;
+            if(!in || !out) {
+                fprintf(stderr, "Not enough memory for %g MP\n", mp*nt);
+                free(in);
+                free(out);
+                break;
+            }
+            timing_t t = run(in, out, w, h, order, type, nt);
+            if(nt == 1)
+                t1 = t;
+            double np = (double)w*h;
+            printf("weak   %7.1f %-11s %3d %8.3f %5.2f %6.2f %8.3f %5.2f "
+                   "%6.2f\n", mp*nt, TransformNames[type], nt,
+                   t.plan, t1.plan/t.plan, plan_bytes(order)*np/t.plan*1e-9,
+                   t.warp, t1.warp/t.warp,
+                   2*sizeof(double)*np/t.warp*1e-9);
+            free(in);
+            free(out);
+        }
+    }
+}
+
+/// Thread scaling of plan creation and homography transform
+int main(int argc, char *argv[]) {
+    if(argc < 2) {
+        fprintf(stderr, "Usage: %s threads [order [MP...]]\n", argv[0]);
+        fprintf(stderr, "threads: maximum number of threads (powers of 2 "
+                        "up to it are tested)\n");
+        fprintf(stderr, "order  : spline order (default %d)\n",
+                MAX_TABULATED_ORDER);
+        fprintf(stderr, "MP     : image sizes in megapixels (default 1 4 16)"
+                        ", the first one is the base size of weak scaling\n");
+        return EXIT_FAILURE;
+    }
+    int maxThreads = atoi(argv[1]);
+    int order = (argc>2)? atoi(argv[2]): MAX_TABULATED_ORDER;
+    if(maxThreads < 1 || order < 0 || order > MAX_ORDER) {
+        fprintf(stderr, "Threads must be positive and order in [0,%d]\n",
+                MAX_ORDER);
+        return EXIT_FAILURE;
+    }
+    double defaultSizes[] = {1, 4, 16};
+    int nSizes = (argc>3)? argc-3: 3;
+    double* sizes = malloc(nSizes*sizeof*sizes);
+    for(int i=0; i<nSizes; i++)
+        sizes[i] = (argc>3)? atof(argv[3+i]): defaultSizes[i];
+
+    printf("# Efficiency: strong T1/(n*Tn), weak T1/Tn. Bandwidth (GB/s) is "
+           "estimated from compulsory memory traffic.\n");
+    printf("mode        MP transform   thr   plan(s)   eff   GB/s"
+           "  warp(s)   eff   GB/s\n");
+    for(int i=0; i<nSizes; i++)
+        strong_scaling(sizes[i], maxThreads, order);
+    weak_scaling(sizes[0], maxThreads, order);
+
+    free(sizes);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_shm.c
+ * @brief Plans in POSIX shared memory, shared by several processes
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// \file splinter_shm.c
+/// The coefficients of a plan are stored in a named shared memory segment,
+/// after a header recording the parameters of the plan. One process creates
+/// the segment and prefilters the image in it; other processes map it
+/// read-only and build a plan around it, after checking that the header
+/// matches the parameters they expect. Only the coefficients are shared; the
+/// kernel and truncation indices, small, are recomputed by each process.
+
+#define _POSIX_C_SOURCE 200112L
+#include "splinter_shm.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SHM_MAGIC "SPLSHM1" ///< Identification of segment and format version
+#define SHM_ALIGN 64 ///< Alignment of coefficients in the segment
+
+/// Header of a segment, followed by the arrays prefilt and tail
+typedef struct {
+    char magic[8]; ///< SHM_MAGIC
+    int w, h, c, order; ///< dimensions and spline order
+    int boundary; ///< boundary extension
+    int larger; ///< prefiltering in larger domain
+    double eps; ///< precision of prefiltering
+    size_t nPrefilt, nTail; ///< sizes of arrays
+    size_t bytes; ///< size of segment
+    volatile int ready; ///< set once the coefficients are computed
+} shm_header_t;
+
+/// Offset of coefficients in segment
+static size_t header_size(void) {
+    return (sizeof(shm_header_t) + SHM_ALIGN-1) / SHM_ALIGN * SHM_ALIGN;
+}
+
+/// Whether header \a hd describes a plan with the given parameters
+static int header_matches(const shm_header_t* hd, int w, int h, int c,
+                          int order, BoundaryExt e, double eps, int larger) {
+    size_t nPrefilt, nTail;
+    splinter_plan_sizes(w, h, c, order, e, eps, larger, &nPrefilt, &nTail);
+    return memcmp(hd->magic, SHM_MAGIC, sizeof(hd->magic)) == 0 &&
+        hd->w == w && hd->h == h && hd->c == c && hd->order == order &&
+        hd->boundary == (int)e && hd->larger == (larger != 0) &&
+        hd->eps == eps && hd->nPrefilt == nPrefilt && hd->nTail == nTail &&
+        hd->bytes == header_size() + (nPrefilt+nTail)*sizeof(double);
+}
+
+/// \brief Create the shared memory segment \a name holding the plan of image
+/// \a in, see \ref splinter_plan_layout.
+/// \details The segment must not exist. The plan is usable by the calling
+/// process, and can be attached by others (\ref splinter_shm_attach) once
+/// created. It must be disposed of by \ref splinter_shm_detach; the segment
+/// remains until \ref splinter_shm_unlink is called and all processes have
+/// detached it. The plan is read-only (\ref splinter_plan_readonly), since
+/// other processes read its coefficients.
+/// \param name name of segment, of the form "/somename"
+/// \return the plan, or an empty plan (NULL \c prefilt) if the segment could
+/// not be created (errno is then set).
+splinter_plan_t splinter_shm_create(const char* name,
+                                    const void* in, splinter_layout_t layout,
+                                    int w, int h, int c, int order,
+                                    BoundaryExt e, double eps, int larger) {
+    splinter_plan_t empty = {.prefilt=NULL};
+    size_t nPrefilt, nTail;
+    splinter_plan_sizes(w, h, c, order, e, eps, larger, &nPrefilt, &nTail);
+    size_t bytes = header_size() + (nPrefilt+nTail)*sizeof(double);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if(fd < 0)
+        return empty;
+    void* base = MAP_FAILED;
+    if(ftruncate(fd, (off_t)bytes) == 0)
+        base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED) {
+        int err = errno;
+        shm_unlink(name);
+        errno = err;
+        return empty;
+    }
+
+    shm_header_t* hd = base;
+    memcpy(hd->magic, SHM_MAGIC, sizeof(hd->magic));
+    hd->w = w;
+    hd->h = h;
+    hd->c = c;
+    hd->order = order;
+    hd->boundary = e;
+    hd->larger = (larger != 0);
+    hd->eps = eps;
+    hd->nPrefilt = nPrefilt;
+    hd->nTail = nTail;
+    hd->bytes = bytes;
+    double* prefilt = (double*)((char*)base + header_size());
+    splinter_plan_t plan = splinter_plan_wrap(prefilt,
+                                              nTail? prefilt+nPrefilt: NULL,
+                                              in, layout, w, h, c, order, e,
+                                              eps, larger);
+    splinter_plan_readonly(plan); // Read by other processes
+    __sync_synchronize(); // Header and coefficients are visible before flag
+    hd->ready = 1;
+    return plan;
+}
+
+/// \brief Attach the plan of shared memory segment \a name, read-only.
+/// \details The parameters are those given to \ref splinter_shm_create. They
+/// are checked against the header of the segment. The plan must be disposed
+/// of by \ref splinter_shm_detach. It is read-only, see
+/// \ref splinter_plan_readonly.
+/// \return the plan, or an empty plan (NULL \c prefilt) if the segment does
+/// not exist, does not match the parameters or is not ready yet (errno is
+/// then ENOENT, EINVAL or EAGAIN respectively).
+splinter_plan_t splinter_shm_attach(const char* name,
+                                    int w, int h, int c, int order,
+                                    BoundaryExt e, double eps, int larger) {
+    splinter_plan_t empty = {.prefilt=NULL};
+    int fd = shm_open(name, O_RDONLY, 0);
+    if(fd < 0)
+        return empty;
+    struct stat st;
+    void* base = MAP_FAILED;
+    if(fstat(fd, &st) == 0 && (size_t)st.st_size >= header_size())
+        base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED) {
+        errno = EAGAIN; // Size is set just after creation
+        return empty;
+    }
+    const shm_header_t* hd = base;
+    int err = 0;
+    if(! hd->ready)
+        err = EAGAIN;
+    __sync_synchronize(); // Flag is read before the header and coefficients
+    if(! err && (! header_matches(hd, w, h, c, order, e, eps, larger) ||
+                 hd->bytes != (size_t)st.st_size))
+        err = EINVAL;
+    if(err) {
+        munmap(base, st.st_size);
+        errno = err;
+        return empty;
+    }
+    double* prefilt = (double*)((char*)base + header_size());
+    splinter_layout_t layout = splinter_layout_planar(w, h);
+    splinter_plan_t plan = splinter_plan_wrap(prefilt,
+                                              hd->nTail? prefilt+hd->nPrefilt:
+                                              NULL, NULL, layout, w, h, c,
+                                              order, e, eps, larger);
+    splinter_plan_readonly(plan); // Mapped read-only
+    return plan;
+}
+
+/// \brief Plan of segment \a name, created if it does not exist.
+/// \details Among concurrent processes, only the one creating the segment
+/// prefilters the image; the others wait for it, up to \a timeout seconds.
+/// The parameters are those of \ref splinter_shm_create.
+/// \return the plan, or an empty plan (NULL \c prefilt) on failure.
+splinter_plan_t splinter_shm_plan(const char* name,
+                                  const void* in, splinter_layout_t layout,
+                                  int w, int h, int c, int order,
+                                  BoundaryExt e, double eps, int larger,
+                                  double timeout) {
+    splinter_plan_t plan = splinter_shm_create(name, in, layout, w, h, c,
+                                               order, e, eps, larger);
+    if(plan.prefilt || errno != EEXIST)
+        return plan;
+    double end = splinter_clock() + timeout;
+    while(1) {
+        plan = splinter_shm_attach(name, w, h, c, order, e, eps, larger);
+        if(plan.prefilt || errno != EAGAIN || splinter_clock() >= end)
+            return plan;
+        struct timespec delay = {0, 1000000}; // 1ms
+        nanosleep(&delay, NULL);
+    }
+}
+
+/// \brief Dispose of a plan of shared memory, unmapping the segment.
+void splinter_shm_detach(splinter_plan_t plan) {
+    if(! plan.prefilt)
+        return;
+    shm_header_t* hd = (shm_header_t*)((char*)plan.prefilt - header_size());
+    size_t bytes = hd->bytes;
+    splinter_destroy_plan(plan);
+    munmap(hd, bytes);
+}
+
+/// \brief Remove the name of segment \a name.
+/// \details The segment is destroyed once all processes have detached it.
+/// \return 0 on success, -1 otherwise (errno is set).
+int splinter_shm_unlink(const char* name) {
+    return shm_unlink(name);
+}
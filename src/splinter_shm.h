@@ -0,0 +1,45 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_shm.h
+ * @brief Plans in POSIX shared memory, shared by several processes
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPLINTERSHM_H
+#define SPLINTERSHM_H
+
+#include "splinter.h"
+
+splinter_plan_t splinter_shm_create(const char* name,
+                                    const void* in, splinter_layout_t layout,
+                                    int w, int h, int c, int order,
+                                    BoundaryExt e, double eps, int larger);
+splinter_plan_t splinter_shm_attach(const char* name,
+                                    int w, int h, int c, int order,
+                                    BoundaryExt e, double eps, int larger);
+splinter_plan_t splinter_shm_plan(const char* name,
+                                  const void* in, splinter_layout_t layout,
+                                  int w, int h, int c, int order,
+                                  BoundaryExt e, double eps, int larger,
+                                  double timeout);
+void splinter_shm_detach(splinter_plan_t plan);
+int splinter_shm_unlink(const char* name);
+
+#endif
@@ -0,0 +1,294 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_threads.c
+ * @brief Multithreading of prefiltering and interpolation
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _POSIX_C_SOURCE 200112L // clock_gettime
+#include "splinter.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+/// Number of threads used by the library
+static int NThreads = 1;
+
+/// \brief Set the number of threads used by subsequent plan creations and
+/// transforms.
+/// \details As in FFTW, this is a global setting. The default is 1 thread.
+void splinter_plan_with_nthreads(int nthreads) {
+    NThreads = (nthreads > 0)? nthreads: 1;
+}
+
+/// \brief Number of threads used by the library.
+int splinter_nthreads(void) {
+    return NThreads;
+}
+
+/// \brief A range of indices submitted to the built-in pool
+typedef struct task_s {
+    splinter_range_fn f; ///< Task
+    void* arg; ///< Argument of task
+    int begin, end; ///< Range of indices
+    int done; ///< Whether the range is processed
+    struct task_s* next; ///< Next task in queue
+} task_t;
+
+/// \brief Built-in pool of worker threads. Members are protected by mutex.
+static struct {
+    pthread_mutex_t mutex; ///< lock of pool and tasks
+    pthread_cond_t work; ///< signaled when a task is queued or at cleanup
+    pthread_cond_t done; ///< signaled when a task is done
+    pthread_t* threads; ///< workers
+    int nThreads; ///< number of workers
+    int stop; ///< workers must exit
+    task_t *first, *last; ///< queue of tasks
+} Pool = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+          PTHREAD_COND_INITIALIZER, NULL, 0, 0, NULL, NULL};
+
+/// \brief Run the first queued task. Pool must be locked and have a task.
+static void run_first_task(void) {
+    task_t* t = Pool.first;
+    Pool.first = t->next;
+    if(! Pool.first)
+        Pool.last = NULL;
+    pthread_mutex_unlock(&Pool.mutex);
+    t->f(t->arg, t->begin, t->end);
+    pthread_mutex_lock(&Pool.mutex);
+    t->done = 1;
+    pthread_cond_broadcast(&Pool.done);
+}
+
+/// \brief Worker thread: run queued tasks until cleanup
+static void* worker(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&Pool.mutex);
+    while(1) {
+        while(!Pool.first && !Pool.stop)
+            pthread_cond_wait(&Pool.work, &Pool.mutex);
+        if(! Pool.first)
+            break;
+        run_first_task();
+    }
+    pthread_mutex_unlock(&Pool.mutex);
+    return NULL;
+}
+
+/// \brief Start workers of the built-in pool until there are \a n. The pool
+/// must be locked.
+static void start_workers(int n) {
+    if(Pool.nThreads >= n)
+        return;
+    pthread_t* th = realloc(Pool.threads, n*sizeof*th);
+    if(! th)
+        return;
+    Pool.threads = th;
+    for(; Pool.nThreads<n; Pool.nThreads++)
+        if(pthread_create(th+Pool.nThreads, NULL, worker, NULL))
+            break;
+}
+
+/// \brief Submit a range to the built-in pool, whose workers are started on
+/// demand. The calling thread counts as one, as it runs a range too.
+static void* pool_submit(void* ctx, splinter_range_fn f, void* arg,
+                         int begin, int end) {
+    (void)ctx;
+    task_t* t = malloc(sizeof*t);
+    task_t task = {f, arg, begin, end, 0, NULL};
+    *t = task;
+    pthread_mutex_lock(&Pool.mutex);
+    start_workers(NThreads-1);
+    if(Pool.last)
+        Pool.last->next = t;
+    else
+        Pool.first = t;
+    Pool.last = t;
+    pthread_cond_signal(&Pool.work);
+    pthread_mutex_unlock(&Pool.mutex);
+    return t;
+}
+
+/// \brief Wait for a range submitted to the built-in pool. Queued ranges are
+/// run meanwhile, so that waiting never deadlocks, even without workers.
+static void pool_wait(void* ctx, void* task) {
+    (void)ctx;
+    task_t* t = task;
+    pthread_mutex_lock(&Pool.mutex);
+    while(! t->done) {
+        if(Pool.first)
+            run_first_task();
+        else
+            pthread_cond_wait(&Pool.done, &Pool.mutex);
+    }
+    pthread_mutex_unlock(&Pool.mutex);
+    free(t);
+}
+
+/// Scheduler used by \ref splinter_parallel_for
+static splinter_scheduler_t Scheduler = {pool_submit, pool_wait, NULL};
+
+/// \brief Run parallel tasks of the library through the scheduler of the host
+/// application, instead of the built-in pool of threads.
+/// \details The number of ranges of each parallel loop is still set by
+/// \ref splinter_plan_with_nthreads, the calling thread running one of them.
+/// It must not be called while the library computes. Background tasks of
+/// \ref splinter_submit go through it too.
+/// \param s scheduler, NULL to restore the built-in pool.
+void splinter_set_scheduler(const splinter_scheduler_t* s) {
+    if(s)
+        Scheduler = *s;
+    else {
+        splinter_scheduler_t builtin = {pool_submit, pool_wait, NULL};
+        Scheduler = builtin;
+    }
+}
+
+/// \brief Stop the workers of the built-in pool.
+/// \details They are restarted when needed. It must not be called while the
+/// library computes.
+void splinter_cleanup_threads(void) {
+    pthread_mutex_lock(&Pool.mutex);
+    Pool.stop = 1;
+    pthread_cond_broadcast(&Pool.work);
+    pthread_mutex_unlock(&Pool.mutex);
+    for(int i=0; i<Pool.nThreads; i++)
+        pthread_join(Pool.threads[i], NULL);
+    free(Pool.threads);
+    Pool.threads = NULL;
+    Pool.nThreads = 0;
+    Pool.stop = 0;
+}
+
+/// \brief Apply \a f to indices [0,n), split in contiguous ranges among
+/// threads.
+/// \details The ranges but the first are submitted to the scheduler, see
+/// \ref splinter_set_scheduler. The calling thread takes the first range and
+/// returns when all ranges are processed.
+/// \param n number of indices
+/// \param f task to apply to each range
+/// \param arg argument of the task, shared by all ranges
+void splinter_parallel_for(int n, splinter_range_fn f, void* arg) {
+    int nt = (NThreads < n)? NThreads: n;
+    if(nt <= 1) {
+        if(n > 0)
+            f(arg, 0, n);
+        return;
+    }
+    splinter_scheduler_t s = Scheduler;
+    void** tasks = malloc(nt*sizeof*tasks);
+    for(int i=1; i<nt; i++)
+        tasks[i] = s.submit(s.ctx, f, arg, (int)((long long)i*n/nt),
+                            (int)((long long)(i+1)*n/nt));
+    f(arg, 0, (int)((long long)n/nt));
+    for(int i=1; i<nt; i++)
+        s.wait(s.ctx, tasks[i]);
+    free(tasks);
+}
+
+/// \brief Submit f(arg,begin,end) to the scheduler, to run in background.
+/// \details Unlike \ref splinter_parallel_for, the calling thread does not
+/// take part: with the built-in pool, at least one worker is started. As the
+/// scheduler may run the task before returning, the task must not wait for
+/// the caller. Used by \ref splinter_homography_async and
+/// \ref splinter_preview.
+/// \return handle of the task, to be passed once to \ref splinter_wait
+void* splinter_submit(splinter_range_fn f, void* arg, int begin, int end) {
+    splinter_scheduler_t s = Scheduler;
+    if(s.submit == pool_submit) {
+        pthread_mutex_lock(&Pool.mutex);
+        start_workers((NThreads > 1)? NThreads-1: 1);
+        pthread_mutex_unlock(&Pool.mutex);
+    }
+    return s.submit(s.ctx, f, arg, begin, end);
+}
+
+/// \brief Wait for completion of a task of \ref splinter_submit.
+void splinter_wait(void* task) {
+    Scheduler.wait(Scheduler.ctx, task);
+}
+
+/// \brief Monotonic clock, in seconds, for deadlines of
+/// \ref splinter_control_t.
+double splinter_clock(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+/// \brief Arguments of an interruptible task
+typedef struct {
+    splinter_range_fn f; ///< Task
+    void* arg; ///< Argument of task
+    const splinter_control_t* ctl; ///< Interruption conditions
+    pthread_mutex_t mutex; ///< Lock of status
+    SplinterStatus status; ///< Set at first interruption
+} control_args_t;
+
+/// \brief Check interruption conditions, return the status
+static SplinterStatus check_control(control_args_t* a) {
+    pthread_mutex_lock(&a->mutex);
+    if(a->status == SPLINTER_OK) {
+        if(a->ctl->cancel && *a->ctl->cancel)
+            a->status = SPLINTER_CANCELLED;
+        else if(a->ctl->deadline > 0 && splinter_clock() >= a->ctl->deadline)
+            a->status = SPLINTER_TIMEOUT;
+    }
+    SplinterStatus status = a->status;
+    pthread_mutex_unlock(&a->mutex);
+    return status;
+}
+
+/// \brief Run a range by bands of SPLINTER_BAND indices, checking
+/// interruption before each band
+static void run_bands(void* args, int begin, int end) {
+    control_args_t* a = args;
+    for(int i=begin; i<end; i+=SPLINTER_BAND) {
+        if(check_control(a) != SPLINTER_OK)
+            return;
+        a->f(a->arg, i, (end-i < SPLINTER_BAND)? end: i+SPLINTER_BAND);
+    }
+}
+
+/// \brief Same as \ref splinter_parallel_for, but the task can be
+/// interrupted.
+/// \details Threads check the conditions before each band of SPLINTER_BAND
+/// indices, and stop at the first one met. The indices already processed are
+/// unspecified after an interruption.
+/// \param ctl interruption conditions, NULL for none
+/// \return SPLINTER_OK if all indices were processed.
+SplinterStatus splinter_parallel_for_control(int n, splinter_range_fn f,
+                                             void* arg,
+                                             const splinter_control_t* ctl) {
+    if(! ctl) {
+        splinter_parallel_for(n, f, arg);
+        return SPLINTER_OK;
+    }
+    control_args_t a;
+    a.f = f;
+    a.arg = arg;
+    a.ctl = ctl;
+    a.status = SPLINTER_OK;
+    pthread_mutex_init(&a.mutex, NULL);
+    splinter_parallel_for(n, run_bands, &a);
+    SplinterStatus status = a.status;
+    pthread_mutex_destroy(&a.mutex);
+    return status;
+}
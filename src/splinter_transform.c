@@ -24,7 +24,9 @@
 
 #include "splinter_transform.h"
 #include "homography_tools.h"
+#include <math.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 /// Apply homography with spline interpolation to an image.
 void splinter_homography(double *out,
@@ -36,6 +38,67 @@ void splinter_homography(double *out,
                              n, boundary, eps, larger, H);
 }
 
+/// Arguments of the parallel tasks of homography transform
+typedef struct {
+    void* out; ///< output image
+    splinter_layout_t layout; ///< layout of output image
+    double x0, y0; ///< top-left corner of output area
+    int i0, i1, j0; ///< columns [i0,i1) of output, first row
+    const double* iH; ///< inverse homography
+    splinter_plan_t plan; ///< interpolation plan
+    int ox, oy; ///< origin of the region of the plan in input image
+} warp_args_t;
+
+/// Store the \a c channels \a v of pixel (i,j) in image \a out of layout
+/// \a layout, converted to its scalar type.
+void splinter_store_pixel(void* out, splinter_layout_t layout, int i, int j,
+                          const double* v, int c) {
+    ptrdiff_t idx = i*layout.xStride + j*layout.yStride;
+    if(layout.type == SPLINTER_FLOAT32)
+        for(int k=0; k<c; k++, idx+=layout.cStride)
+            ((float*)out)[idx] = (float)v[k];
+    else
+        for(int k=0; k<c; k++, idx+=layout.cStride)
+            ((double*)out)[idx] = v[k];
+}
+
+/// Interpolate the rectangle [i0,i1)x[j0,j1) of the output image, the plan
+/// covering the region of origin (ox,oy) of the input image.
+static void warp_tile(void *out, splinter_layout_t layout,
+                      double x0, double y0, int i0, int j0, int i1, int j1,
+                      splinter_plan_t plan, const double iH[9],
+                      int ox, int oy) {
+    int c = plan.c;
+    double p[2], q[2];
+    double* outp = malloc(c*sizeof*outp);
+    for(int j = j0; j < j1; j++) {
+        p[1] = j+y0;
+        for(int i = i0; i < i1; i++) {
+            p[0] = i+x0;
+            apply_homography(q, p, iH);
+            splinter(outp, q[0]-ox, q[1]-oy, plan);
+            splinter_store_pixel(out, layout, i, j, outp, c);
+        }
+    }
+    free(outp);
+}
+
+/// Interpolate the rectangle [i0,i1)x[j0,j1) of the output image, whose
+/// top-left pixel is at (x0,y0). \a iH is the inverse homography.
+void splinter_homography_tile(void *out, splinter_layout_t layout,
+                              double x0, double y0,
+                              int i0, int j0, int i1, int j1,
+                              splinter_plan_t plan, const double iH[9]) {
+    warp_tile(out, layout, x0, y0, i0, j0, i1, j1, plan, iH, 0, 0);
+}
+
+/// Interpolate rows [j0,j1) of output, relative to the first row
+static void warp_rows(void* args, int j0, int j1) {
+    const warp_args_t* a = args;
+    warp_tile(a->out, a->layout, a->x0, a->y0, a->i0, a->j0+j0, a->i1,
+              a->j0+j1, a->plan, a->iH, a->ox, a->oy);
+}
+
 /// Apply homography with spline interpolation to an image, specifying the
 /// output area.
 void splinter_homography_geom(double *out,
@@ -44,27 +107,489 @@ void splinter_homography_geom(double *out,
                               int w, int h, int c,
                               int n, BoundaryExt boundary, double eps,
                               int larger, const double H[9]) {
+    splinter_plan_t plan = splinter_plan(in,w,h,c, n, boundary, eps, larger);
+    splinter_homography_with_plan(out, x0, y0, wout, hout, plan, H);
+    splinter_destroy_plan(plan);
+}
+
+/// Apply homography to an image whose plan is already computed, specifying
+/// the output area. Rows of output are distributed among threads, see
+/// \ref splinter_plan_with_nthreads.
+void splinter_homography_with_plan(double *out,
+                                   double x0, double y0, int wout, int hout,
+                                   splinter_plan_t plan, const double H[9]) {
+    splinter_homography_layout(out, splinter_layout_planar(wout, hout),
+                               x0, y0, wout, hout, plan, H);
+}
+
+/// Apply homography to an image whose plan is already computed, specifying
+/// the output area and the layout of output image (e.g., interleaved channels
+/// or float values).
+void splinter_homography_layout(void *out, splinter_layout_t layout,
+                                double x0, double y0, int wout, int hout,
+                                splinter_plan_t plan, const double H[9]) {
+    splinter_homography_control(out, layout, x0, y0, wout, hout, plan, H,
+                                NULL);
+}
+
+/// Arguments of the traversal of output tiles
+typedef struct {
+    void* out; ///< output image
+    splinter_layout_t layout; ///< layout of output image
+    double x0, y0; ///< top-left corner of output area
+    int wout, hout; ///< size of output
+    const double* iH; ///< inverse homography
+    double sign; ///< sign of denominator of iH on the side of output center
+    splinter_plan_t plan; ///< interpolation plan
+    int tile, ntx, n; ///< side of tiles, number per row, number of tiles
+    const int* order; ///< tiles in order of traversal
+    size_t maxPrefetch; ///< largest footprint to prefetch, in bytes
+} traversal_args_t;
+
+/// Tile with its position along the space-filling curve
+typedef struct {
+    unsigned long long key; ///< Hilbert index of source position
+    int index; ///< index of tile in row order
+} tile_order_t;
+
+/// Comparison of Hilbert indices for qsort
+static int compare_keys(const void* a, const void* b) {
+    unsigned long long u = ((const tile_order_t*)a)->key;
+    unsigned long long v = ((const tile_order_t*)b)->key;
+    return (u>v) - (u<v);
+}
+
+/// Index of cell (x,y) along the Hilbert curve covering 2^16 x 2^16 cells
+static unsigned long long hilbert_index(unsigned x, unsigned y) {
+    unsigned long long d = 0;
+    for(unsigned s = 1u<<15; s > 0; s >>= 1) {
+        unsigned rx = (x & s) > 0, ry = (y & s) > 0;
+        d += (unsigned long long)s * s * ((3*rx) ^ ry);
+        if(ry == 0) { // rotate quadrant
+            if(rx == 1) {
+                x = s-1 - (x & (s-1));
+                y = s-1 - (y & (s-1));
+            }
+            unsigned t = x; x = y; y = t;
+        }
+    }
+    return d;
+}
+
+/// Rectangle [i0,i1)x[j0,j1) of output covered by tile \a t
+static void tile_rect(const traversal_args_t* a, int t, int r[4]) {
+    r[0] = (t % a->ntx)*a->tile;
+    r[1] = (t / a->ntx)*a->tile;
+    r[2] = (r[0]+a->tile < a->wout)? r[0]+a->tile: a->wout;
+    r[3] = (r[1]+a->tile < a->hout)? r[1]+a->tile: a->hout;
+}
+
+/// Prefetch the coefficients read by the interpolations of tile \a t: the
+/// rows of the bounding box of the preimages of its corners, kernel included
+static void prefetch_tile(const traversal_args_t* a, int t) {
+#ifdef __GNUC__
+    const splinter_plan_t* p = &a->plan;
+    int r[4];
+    tile_rect(a, t, r);
+    double bb[4] = {INFINITY, INFINITY, -INFINITY, -INFINITY};
+    for(int k=0; k<4; k++) {
+        double c[2] = {a->x0 + r[2*(k&1)] - (k&1),
+                       a->y0 + r[1+2*(k>>1)] - (k>>1)};
+        double den = a->iH[6]*c[0] + a->iH[7]*c[1] + a->iH[8];
+        if(a->sign*den <= 0)
+            return; // Beyond the horizon
+        double q[2];
+        apply_homography(q, c, a->iH);
+        bb[0] = fmin(bb[0], q[0]); bb[1] = fmin(bb[1], q[1]);
+        bb[2] = fmax(bb[2], q[0]); bb[3] = fmax(bb[3], q[1]);
+    }
+    int radius = p->bspline->order/2 + 1;
+    int xa = (int)fmax(0, floor(bb[0]) + p->shift - radius);
+    int ya = (int)fmax(0, floor(bb[1]) + p->shift - radius);
+    int xb = (int)fmin(p->w-1, ceil(bb[2]) + p->shift + radius);
+    int yb = (int)fmin(p->h-1, ceil(bb[3]) + p->shift + radius);
+    if(xa > xb || ya > yb ||
+       (size_t)(xb-xa+1)*(yb-ya+1)*p->c*sizeof(double) > a->maxPrefetch)
+        return;
+    for(int l=0; l<p->c; l++)
+        for(int y=ya; y<=yb; y++) {
+            const double* row = p->prefilt + ((ptrdiff_t)l*p->h + y)*p->w;
+            for(int x=xa; x<=xb; x+=8) // 64-byte cache lines
+                __builtin_prefetch(row+x);
+        }
+#else
+    (void)a; (void)t;
+#endif
+}
+
+/// Interpolate rows [k0,k1) of the traversal, row k being row k%tile of
+/// tile order[k/tile]. The next tile is prefetched when a tile is started.
+static void traverse_tiles(void* args, int k0, int k1) {
+    const traversal_args_t* a = args;
+    if(k0 < k1)
+        prefetch_tile(a, a->order[k0/a->tile]);
+    for(int k=k0; k<k1; ) {
+        int s = k/a->tile, row = k%a->tile;
+        int end = (row + k1-k < a->tile)? row + k1-k: a->tile;
+        if(row == 0 && s+1 < a->n)
+            prefetch_tile(a, a->order[s+1]);
+        int r[4];
+        tile_rect(a, a->order[s], r);
+        int j0 = r[1]+row, j1 = (r[1]+end < r[3])? r[1]+end: r[3];
+        if(j0 < j1)
+            warp_tile(a->out, a->layout, a->x0, a->y0, r[0], j0, r[2], j1,
+                      a->plan, a->iH, 0, 0);
+        k += end-row;
+    }
+}
+
+#define SEGMENTS 4 ///< Segments of the tile curve per thread
+
+/// Size of the last level cache of a core, in bytes
+static size_t cache_size(void) {
+    long size = 0;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    return (size > 0)? (size_t)size: 256*1024;
+}
+
+/// Same as \ref splinter_homography_layout, but the transform stops early
+/// when a condition of \a ctl is met, leaving part of the output unset.
+/// \details The output is cut in square tiles, traversed in the order of
+/// their preimages along a Hilbert curve in the input image, so that
+/// successive tiles read neighbor coefficients. The side of tiles is such
+/// that the coefficients read by a tile fit in the cache, given the local
+/// scale of the homography at the center of the output. The coefficients of
+/// the next tile are prefetched while the current one is computed. Tiles are
+/// smaller if needed to give several to each thread. The curve is cut in
+/// SEGMENTS segments per thread, dealt in turn to threads, so that each
+/// thread follows the curve within a segment while the cheap tiles outside
+/// the image are shared. Conditions of \a ctl are checked every
+/// SPLINTER_BAND rows of tiles.
+/// Return SPLINTER_OK if the output is complete.
+SplinterStatus splinter_homography_control(void *out, splinter_layout_t layout,
+                                           double x0, double y0,
+                                           int wout, int hout,
+                                           splinter_plan_t plan,
+                                           const double H[9],
+                                           const splinter_control_t* ctl) {
+    if(wout <= 0 || hout <= 0)
+        return SPLINTER_OK;
     // invert homography
     double iH[9];
     invert_homography(iH, H);
 
-    splinter_plan_t plan = splinter_plan(in,w,h,c, n, boundary, eps, larger);
+    // Local scale: longest image by iH of a unit vector at output center
+    double c[3][2] = {{x0+wout/2.0, y0+hout/2.0}}, q[3][2];
+    c[1][0] = c[0][0]+1; c[1][1] = c[0][1];
+    c[2][0] = c[0][0];   c[2][1] = c[0][1]+1;
+    for(int k=0; k<3; k++)
+        apply_homography(q[k], c[k], iH);
+    double scale = fmax(hypot(q[1][0]-q[0][0], q[1][1]-q[0][1]),
+                        hypot(q[2][0]-q[0][0], q[2][1]-q[0][1]));
+    if(! (scale > 1e-3) || ! isfinite(scale))
+        scale = 1;
+    // H is defined up to scale: output center is before the horizon
+    double sign = (iH[6]*c[0][0] + iH[7]*c[0][1] + iH[8] < 0)? -1: 1;
 
-    // computation of the pixel locations
-    double p[2], q[2];
+    // Side of tiles: footprint (scale*tile+order+1)^2 in cache
+    size_t cache = cache_size();
+    double side = sqrt(cache/(double)(plan.c*sizeof(double)));
+    int tile = (int)((side - plan.bspline->order-1) / scale);
+    if(tile < 8) tile = 8;
+    if(tile > 128) tile = 128;
+    int nt = splinter_nthreads();
+    while(tile > 8 &&
+          ((wout+tile-1)/tile)*((hout+tile-1)/tile) < 4*SEGMENTS*nt)
+        tile /= 2;
+
+    // Order tiles by Hilbert index of their preimage
+    int ntx = (wout+tile-1)/tile, nty = (hout+tile-1)/tile, n = ntx*nty;
+    tile_order_t* keys = malloc(n*sizeof*keys);
+    double cell = tile*scale;
+    for(int t=0; t<n; t++) {
+        double p[2] = {x0 + (t%ntx + 0.5)*tile, y0 + (t/ntx + 0.5)*tile};
+        double den = iH[6]*p[0] + iH[7]*p[1] + iH[8];
+        keys[t].index = t;
+        keys[t].key = ~0ull; // Beyond the horizon: last
+        if(sign*den > 0) {
+            apply_homography(q[0], p, iH);
+            double u = q[0][0]/cell + 32768, v = q[0][1]/cell + 32768;
+            if(0 <= u && u < 65536 && 0 <= v && v < 65536)
+                keys[t].key = hilbert_index((unsigned)u, (unsigned)v);
+        }
+    }
+    qsort(keys, n, sizeof*keys, compare_keys);
+    // Deal segments of the curve in turn to the contiguous ranges of threads
+    int ns = (nt > 1)? nt*SEGMENTS: 1;
+    if(ns > n)
+        ns = n;
+    int* order = malloc(n*sizeof*order);
+    for(int r=0, t=0; r<nt && r<ns; r++)
+        for(int s=r; s<ns; s+=nt)
+            for(int k=(int)((long long)s*n/ns); k<(long long)(s+1)*n/ns; k++)
+                order[t++] = keys[k].index;
+    free(keys);
+
+    traversal_args_t args = {out, layout, x0, y0, wout, hout, iH, sign, plan,
+                             tile, ntx, n, order, 2*cache};
+    SplinterStatus status = splinter_parallel_for_control(n*tile,
+                                                          traverse_tiles,
+                                                          &args, ctl);
+    free(order);
+    return status;
+}
+
+/// Arguments of the approximate homography transform
+typedef struct {
+    void* out; ///< output image
+    splinter_layout_t layout; ///< layout of output image
+    double x0, y0; ///< top-left corner of output area
+    int wout, hout, nbx; ///< size of output, number of blocks per row
+    const double* iH; ///< inverse homography
+    splinter_plan_t plan; ///< interpolation plan
+    double tol; ///< tolerance on positions, in input pixels
+} approx_args_t;
+
+/// Bound of the error of the bilinear interpolation of the preimages of the
+/// corners of the rectangle [i0,i1]x[j0,j1] of output pixels, or HUGE_VAL if
+/// the horizon line may cross the rectangle.
+/// \details Along direction u, a coordinate N/D of the preimage, with N and D
+/// affine, has second derivative -2a(bD-aN)/D^3, where a and b are the
+/// derivatives of D and N along u. Since bD-aN is affine and constant along u,
+/// its maximum, as the minimum of |D|, is reached at a corner. The error is
+/// at most (i1-i0)^2/8 times the bound of the second derivative along x, plus
+/// (j1-j0)^2/8 times the one along y.
+static double approx_error(const approx_args_t* a,
+                           int i0, int j0, int i1, int j1) {
+    const double* iH = a->iH;
+    double dMin = HUGE_VAL, C[2][2] = {{0, 0}, {0, 0}};
+    int pos = 0, neg = 0;
+    for(int k=0; k<4; k++) {
+        double p[2] = {((k&1)? i1: i0)+a->x0, ((k&2)? j1: j0)+a->y0};
+        double d = iH[6]*p[0] + iH[7]*p[1] + iH[8];
+        pos += (d > 0);
+        neg += (d < 0);
+        dMin = fmin(dMin, fabs(d));
+        for(int l=0; l<2; l++) {
+            double n = iH[3*l]*p[0] + iH[3*l+1]*p[1] + iH[3*l+2];
+            for(int u=0; u<2; u++)
+                C[u][l] = fmax(C[u][l], fabs(iH[3*l+u]*d - iH[6+u]*n));
+        }
+    }
+    if(pos != 4 && neg != 4)
+        return HUGE_VAL;
+    double len[2] = {i1-i0, j1-j0}, e[2] = {0, 0};
+    for(int u=0; u<2; u++)
+        for(int l=0; l<2; l++)
+            e[l] += len[u]*len[u]/4 * fabs(iH[6+u])*C[u][l];
+    return hypot(e[0], e[1]) / (dMin*dMin*dMin);
+}
+
+/// Interpolate the rectangle [i0,i1)x[j0,j1) of output, the preimages of its
+/// pixels being interpolated from those of its corners if the error is within
+/// tolerance. Otherwise the rectangle is split in four, unless rectangles
+/// meeting the tolerance would be smaller than 4x4 pixels, in which case all
+/// preimages are exact.
+static void approx_block(const approx_args_t* a,
+                         int i0, int j0, int i1, int j1) {
+    double err = approx_error(a, i0, j0, i1-1, j1-1);
+    if(err > a->tol) {
+        // The error is quadratic in the side of the rectangle
+        int side = (i1-i0 > j1-j0)? i1-i0: j1-j0;
+        if(side*sqrt(a->tol/err) >= 4) {
+            int im = (i1-i0 > 1)? (i0+i1)/2: i1, jm = (j1-j0>1)? (j0+j1)/2: j1;
+            approx_block(a, i0, j0, im, jm);
+            if(im < i1)
+                approx_block(a, im, j0, i1, jm);
+            if(jm < j1) {
+                approx_block(a, i0, jm, im, j1);
+                if(im < i1)
+                    approx_block(a, im, jm, i1, j1);
+            }
+        } else
+            warp_tile(a->out, a->layout, a->x0, a->y0, i0, j0, i1, j1,
+                      a->plan, a->iH, 0, 0);
+        return;
+    }
+    double q[4][2];
+    for(int k=0; k<4; k++) {
+        double p[2] = {((k&1)? i1-1: i0)+a->x0, ((k&2)? j1-1: j0)+a->y0};
+        apply_homography(q[k], p, a->iH);
+    }
+    int c = a->plan.c;
     double* outp = malloc(c*sizeof*outp);
-    for(int j = 0; j < hout; j++) {
-        p[1] = j+y0;
-        for(int i = 0; i < wout; i++) {
-            p[0] = i+x0;
-            apply_homography(q, p, iH);
-            splinter(outp, q[0], q[1], plan);
-            for(int k=0; k<c; k++)
-                out[k*wout*hout] = outp[k];
-            ++out;
+    for(int j = j0; j < j1; j++) {
+        double v = (j1-j0 > 1)? (double)(j-j0)/(j1-1-j0): 0;
+        double l[2] = {q[0][0] + v*(q[2][0]-q[0][0]),
+                       q[0][1] + v*(q[2][1]-q[0][1])};
+        double r[2] = {q[1][0] + v*(q[3][0]-q[1][0]),
+                       q[1][1] + v*(q[3][1]-q[1][1])};
+        for(int i = i0; i < i1; i++) {
+            double u = (i1-i0 > 1)? (double)(i-i0)/(i1-1-i0): 0;
+            splinter(outp, l[0]+u*(r[0]-l[0]), l[1]+u*(r[1]-l[1]), a->plan);
+            splinter_store_pixel(a->out, a->layout, i, j, outp, c);
         }
     }
     free(outp);
+}
+
+/// Interpolate blocks [b0,b1) of output, in row order
+static void approx_blocks(void* args, int b0, int b1) {
+    const approx_args_t* a = args;
+    for(int b=b0; b<b1; b++) {
+        int i0 = (b % a->nbx)*SPLINTER_BLOCK, j0 = (b / a->nbx)*SPLINTER_BLOCK;
+        int i1 = (i0+SPLINTER_BLOCK < a->wout)? i0+SPLINTER_BLOCK: a->wout;
+        int j1 = (j0+SPLINTER_BLOCK < a->hout)? j0+SPLINTER_BLOCK: a->hout;
+        approx_block(a, i0, j0, i1, j1);
+    }
+}
+
+/// Same as \ref splinter_homography_control, but the preimages of output
+/// pixels are approximated, within \a tol input pixels.
+/// \details The inverse homography is evaluated exactly only at the corners
+/// of blocks of SPLINTER_BLOCK x SPLINTER_BLOCK output pixels, and the
+/// preimages inside are interpolated bilinearly, saving a division per pixel.
+/// Blocks for which a bound of the error exceeds \a tol, near the horizon or
+/// under strong perspective, are split in four recursively. Affine transforms
+/// are interpolated exactly, up to rounding. Conditions of \a ctl are checked
+/// every SPLINTER_BAND blocks.
+SplinterStatus splinter_homography_approx(void *out, splinter_layout_t layout,
+                                          double x0, double y0,
+                                          int wout, int hout,
+                                          splinter_plan_t plan,
+                                          const double H[9], double tol,
+                                          const splinter_control_t* ctl) {
+    if(wout <= 0 || hout <= 0)
+        return SPLINTER_OK;
+    double iH[9];
+    invert_homography(iH, H);
+    int nbx = (wout+SPLINTER_BLOCK-1)/SPLINTER_BLOCK;
+    int nby = (hout+SPLINTER_BLOCK-1)/SPLINTER_BLOCK;
+    approx_args_t args = {out, layout, x0, y0, wout, hout, nbx, iH, plan, tol};
+    return splinter_parallel_for_control(nbx*nby, approx_blocks, &args, ctl);
+}
+
+/// \brief Memory of a homography transform, in bytes.
+/// \details This is the plan, see \ref splinter_plan_bytes, the output image
+/// of \a wout x \a hout pixels with values of type \a type, and the workspace
+/// of the threads.
+size_t splinter_warp_bytes(int wout, int hout, SplinterType type,
+                           int w, int h, int c, int order,
+                           BoundaryExt boundary, double eps, int larger) {
+    size_t size = (type == SPLINTER_FLOAT32)? sizeof(float): sizeof(double);
+    return splinter_plan_bytes(w, h, c, order, boundary, eps, larger) +
+        (size_t)wout*hout*c*size + (size_t)splinter_nthreads()*c*sizeof(double);
+}
+
+/// Arguments of the homography transform within a memory budget
+typedef struct {
+    void* out; ///< output image
+    splinter_layout_t outLayout; ///< layout of output image
+    double x0, y0; ///< top-left corner of output area
+    const void* in; ///< input image
+    splinter_layout_t layout; ///< layout of input image
+    int w, h, c, order; ///< input dimensions and spline order
+    BoundaryExt boundary; ///< boundary extension
+    double eps; ///< precision of prefiltering
+    const double* iH; ///< inverse homography
+    size_t budget; ///< maximum memory of the plan of a region
+} budget_args_t;
 
+/// Interpolate the rectangle [i0,i1)x[j0,j1) of output with the plan of its
+/// footprint in the input image, split in four if this plan would exceed the
+/// budget or if the horizon line crosses the rectangle.
+static void warp_footprint(const budget_args_t* a,
+                           int i0, int j0, int i1, int j1) {
+    const double* iH = a->iH;
+    double xMin=HUGE_VAL, xMax=-HUGE_VAL, yMin=HUGE_VAL, yMax=-HUGE_VAL;
+    int pos = 0, neg = 0;
+    for(int k=0; k<4; k++) { // The footprint is within the corners' hull
+        double p[2] = {((k&1)? i1-1: i0)+a->x0, ((k&2)? j1-1: j0)+a->y0}, q[2];
+        double d = iH[6]*p[0] + iH[7]*p[1] + iH[8];
+        pos += (d > 0);
+        neg += (d < 0);
+        apply_homography(q, p, iH);
+        xMin = fmin(xMin, q[0]); xMax = fmax(xMax, q[0]);
+        yMin = fmin(yMin, q[1]); yMax = fmax(yMax, q[1]);
+    }
+    const double bound = 1<<29; // Avoids overflow, far beyond any image
+    int region[4] = {0, 0, 1, 1}, split = 1;
+    splinter_plan_t plan = {.prefilt=NULL};
+    if(pos == 4 || neg == 4) {
+        // One pixel of slack for rounding errors inside the rectangle
+        region[0] = (int)floor(fmax(xMin, -bound)) - 1;
+        region[1] = (int)floor(fmax(yMin, -bound)) - 1;
+        region[2] = (int)ceil(fmin(xMax, bound)) - region[0] + 2;
+        region[3] = (int)ceil(fmin(yMax, bound)) - region[1] + 2;
+        plan = splinter_plan_region(a->in, a->layout, a->w, a->h, a->c,
+                                    a->order, a->boundary, a->eps, region,
+                                    a->budget);
+        // Splitting is useless if the margin of the larger domain dominates
+        size_t whole = splinter_plan_bytes(region[2], region[3], a->c,
+                                           a->order, a->boundary, a->eps, 1);
+        size_t half = splinter_plan_bytes((region[2]+1)/2, (region[3]+1)/2,
+                                          a->c, a->order, a->boundary, a->eps,
+                                          1);
+        split = (2*half <= whole);
+    }
+    if(! plan.prefilt && split && (i1-i0 > 1 || j1-j0 > 1)) {
+        int im = (i1-i0 > 1)? (i0+i1)/2: i1, jm = (j1-j0 > 1)? (j0+j1)/2: j1;
+        warp_footprint(a, i0, j0, im, jm);
+        if(im < i1)
+            warp_footprint(a, im, j0, i1, jm);
+        if(jm < j1) {
+            warp_footprint(a, i0, jm, im, j1);
+            if(im < i1)
+                warp_footprint(a, im, jm, i1, j1);
+        }
+        return;
+    }
+    if(! plan.prefilt) // Budget cannot be met
+        plan = splinter_plan_region(a->in, a->layout, a->w, a->h, a->c,
+                                    a->order, a->boundary, a->eps, region,
+                                    (size_t)-1);
+
+    warp_args_t args = {a->out, a->outLayout, a->x0, a->y0, i0, i1, j0, iH,
+                        plan, region[0], region[1]};
+    splinter_parallel_for(j1-j0, warp_rows, &args);
     splinter_destroy_plan(plan);
 }
+
+/// Apply homography to an image, see \ref splinter_homography_layout, with
+/// memory bounded by \a budget bytes if possible.
+/// \details If the transform fits in the budget, see
+/// \ref splinter_warp_bytes, the plan of the whole image is computed.
+/// Otherwise the output is split in rectangles, as large as possible, whose
+/// footprints in the input image are prefiltered one at a time, in the larger
+/// domain, see \ref splinter_plan_region. The budget of these plans is what
+/// remains after the output image. Rectangles are not split further, even if
+/// the budget is exceeded, when this would not reduce the memory because of
+/// the margin of the larger domain.
+void splinter_homography_budget(void *out, splinter_layout_t outLayout,
+                                double x0, double y0, int wout, int hout,
+                                const void *in, splinter_layout_t layout,
+                                int w, int h, int c,
+                                int order, BoundaryExt boundary, double eps,
+                                int larger, const double H[9], size_t budget) {
+    size_t bytes = splinter_warp_bytes(wout, hout, outLayout.type, w, h, c,
+                                       order, boundary, eps, larger);
+    if(bytes <= budget) {
+        splinter_plan_t plan = splinter_plan_layout(in, layout, w, h, c, order,
+                                                    boundary, eps, larger);
+        splinter_homography_layout(out, outLayout, x0, y0, wout, hout,
+                                   plan, H);
+        splinter_destroy_plan(plan);
+        return;
+    }
+    if(wout <= 0 || hout <= 0)
+        return;
+    double iH[9];
+    invert_homography(iH, H);
+    size_t fixed = bytes - splinter_plan_bytes(w, h, c, order, boundary, eps,
+                                               larger);
+    budget_args_t args = {out, outLayout, x0, y0, in, layout, w, h, c, order,
+                          boundary, eps, iH, (budget>fixed)? budget-fixed: 0};
+    warp_footprint(&args, 0, 0, wout, hout);
+}
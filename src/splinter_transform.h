@@ -27,6 +27,10 @@
 
 #include "splinter.h"
 
+/// Side of tiles of asynchronous and sliced transforms
+#define SPLINTER_TILE 64
+#define SPLINTER_BLOCK 16 ///< Side of blocks of approximate transforms
+
 void splinter_homography(double *out, const double *in, int w, int h, int c,
                          int order, BoundaryExt boundary, double eps,
                          int larger, const double homo[9]);
@@ -34,5 +38,39 @@ void splinter_homography_geom(double *out, double x0, double y0, int wo, int ho,
                               const double *in, int w, int h, int c,
                               int order, BoundaryExt boundary, double eps,
                               int larger, const double homo[9]);
+void splinter_homography_with_plan(double *out, double x0, double y0,
+                                   int wo, int ho, splinter_plan_t plan,
+                                   const double homo[9]);
+void splinter_homography_layout(void *out, splinter_layout_t layout,
+                                double x0, double y0, int wo, int ho,
+                                splinter_plan_t plan, const double homo[9]);
+SplinterStatus splinter_homography_control(void *out, splinter_layout_t layout,
+                                           double x0, double y0,
+                                           int wo, int ho,
+                                           splinter_plan_t plan,
+                                           const double homo[9],
+                                           const splinter_control_t* ctl);
+SplinterStatus splinter_homography_approx(void *out, splinter_layout_t layout,
+                                          double x0, double y0,
+                                          int wo, int ho,
+                                          splinter_plan_t plan,
+                                          const double homo[9], double tol,
+                                          const splinter_control_t* ctl);
+void splinter_store_pixel(void* out, splinter_layout_t layout, int i, int j,
+                          const double* v, int c);
+void splinter_homography_tile(void *out, splinter_layout_t layout,
+                              double x0, double y0,
+                              int i0, int j0, int i1, int j1,
+                              splinter_plan_t plan, const double iH[9]);
+size_t splinter_warp_bytes(int wo, int ho, SplinterType type,
+                           int w, int h, int c, int order,
+                           BoundaryExt boundary, double eps, int larger);
+void splinter_homography_budget(void *out, splinter_layout_t outLayout,
+                                double x0, double y0, int wo, int ho,
+                                const void *in, splinter_layout_t layout,
+                                int w, int h, int c,
+                                int order, BoundaryExt boundary, double eps,
+                                int larger, const double homo[9],
+                                size_t budget);
 
 #endif
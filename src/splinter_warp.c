@@ -0,0 +1,170 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_warp.c
+ * @brief Resumable homography transforms, computed by time slices
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// \file splinter_warp.c
+/// A transform is computed by successive calls to \ref splinter_warp_step,
+/// each one limited in time or number of pixels, so that an interactive
+/// program can stay responsive. The output is cut in tiles of SPLINTER_TILE x
+/// SPLINTER_TILE pixels. Tiles covering the viewport are computed first, the
+/// others by increasing distance to it.
+/// \code
+/// splinter_warp_t* warp = splinter_warp_init(out, layout, 0, 0, wo, ho,
+///                                            plan, H);
+/// splinter_warp_viewport(warp, vx, vy, vw, vh);   // Visible area
+/// while(splinter_warp_step(warp, 0.01, 0) > 0)   // Slices of 10ms
+///     process_events();
+/// splinter_warp_finish(warp);
+/// \endcode
+
+#include "splinter_warp.h"
+#include "homography_tools.h"
+#include <stdlib.h>
+
+/// State of a resumable transform
+struct splinter_warp_s {
+    void* out; ///< output image
+    splinter_layout_t layout; ///< layout of output image
+    double x0, y0; ///< top-left corner of output area
+    int wout, hout; ///< size of output
+    splinter_plan_t plan; ///< interpolation plan
+    double iH[9]; ///< inverse homography
+    int tilesX, nTiles; ///< number of tiles in a row, total number
+    int* order; ///< tiles in order of computation
+    int next; ///< index in order of the next tile to compute
+    long remaining; ///< number of pixels not yet computed
+};
+
+/// A tile and its priority, lower being computed first
+typedef struct {
+    double key; ///< priority
+    int tile; ///< tile index
+} priority_t;
+
+/// Comparison of priorities for qsort
+static int compare_priority(const void* a, const void* b) {
+    double ka = ((const priority_t*)a)->key, kb = ((const priority_t*)b)->key;
+    return (ka > kb) - (ka < kb);
+}
+
+/// Bounds of tile \a t in output image
+static void tile_bounds(const splinter_warp_t* w, int t,
+                        int* i0, int* j0, int* i1, int* j1) {
+    *i0 = (t % w->tilesX)*SPLINTER_TILE;
+    *j0 = (t / w->tilesX)*SPLINTER_TILE;
+    *i1 = (*i0+SPLINTER_TILE < w->wout)? *i0+SPLINTER_TILE: w->wout;
+    *j1 = (*j0+SPLINTER_TILE < w->hout)? *j0+SPLINTER_TILE: w->hout;
+}
+
+/// \brief Start a resumable transform, see \ref splinter_homography_layout.
+/// \details No pixel is computed yet. Tiles are computed in row order, unless
+/// a viewport is given by \ref splinter_warp_viewport. The output image must
+/// not be used, nor the plan destroyed, before the transform is finished.
+/// \return state of the transform, to be disposed of by
+/// \ref splinter_warp_finish or \ref splinter_warp_abort.
+splinter_warp_t* splinter_warp_init(void *out, splinter_layout_t layout,
+                                    double x0, double y0, int wout, int hout,
+                                    splinter_plan_t plan, const double H[9]) {
+    splinter_warp_t* w = malloc(sizeof*w);
+    w->out = out;
+    w->layout = layout;
+    w->x0 = x0;
+    w->y0 = y0;
+    w->wout = (wout > 0)? wout: 0;
+    w->hout = (hout > 0)? hout: 0;
+    w->plan = plan;
+    invert_homography(w->iH, H);
+    w->tilesX = (w->wout + SPLINTER_TILE-1) / SPLINTER_TILE;
+    w->nTiles = w->tilesX * ((w->hout + SPLINTER_TILE-1) / SPLINTER_TILE);
+    w->order = malloc(w->nTiles*sizeof*w->order);
+    for(int t=0; t<w->nTiles; t++)
+        w->order[t] = t;
+    w->next = 0;
+    w->remaining = (long)w->wout*w->hout;
+    return w;
+}
+
+/// \brief Set the visible area of output, in output pixels.
+/// \details The tiles not yet computed are reordered: those intersecting the
+/// viewport first, from its center, then the others by increasing distance to
+/// the viewport. It can be called between steps, e.g., when the view scrolls.
+/// \param vx,vy top-left pixel of viewport
+/// \param vw,vh size of viewport
+void splinter_warp_viewport(splinter_warp_t* w, int vx, int vy, int vw, int vh){
+    int n = w->nTiles - w->next;
+    priority_t* p = malloc(n*sizeof*p);
+    double cx = vx+0.5*vw, cy = vy+0.5*vh;
+    for(int k=0; k<n; k++) {
+        int i0, j0, i1, j1;
+        p[k].tile = w->order[w->next+k];
+        tile_bounds(w, p[k].tile, &i0, &j0, &i1, &j1);
+        // Distance from tile to viewport, 0 if they intersect
+        double dx = (i1 <= vx)? vx-i1+1: (i0 >= vx+vw)? i0-(vx+vw)+1: 0;
+        double dy = (j1 <= vy)? vy-j1+1: (j0 >= vy+vh)? j0-(vy+vh)+1: 0;
+        // Distance from tile center to viewport center, as tie-breaker
+        double ex = 0.5*(i0+i1)-cx, ey = 0.5*(j0+j1)-cy;
+        double diag = (double)w->wout*w->wout + (double)w->hout*w->hout + 1;
+        p[k].key = (dx*dx + dy*dy) + (ex*ex + ey*ey)/diag;
+    }
+    qsort(p, n, sizeof*p, compare_priority);
+    for(int k=0; k<n; k++)
+        w->order[w->next+k] = p[k].tile;
+    free(p);
+}
+
+/// \brief Compute tiles until the budget is exhausted.
+/// \details At least one tile is computed, if any remains. The budget is
+/// checked after each tile.
+/// \param seconds time budget (0 for no limit)
+/// \param pixels pixel budget (0 for no limit)
+/// \return number of pixels remaining to compute, 0 when the transform is
+/// complete.
+long splinter_warp_step(splinter_warp_t* w, double seconds, long pixels) {
+    double tEnd = splinter_clock() + seconds;
+    long done = 0;
+    while(w->next < w->nTiles) {
+        int i0, j0, i1, j1;
+        tile_bounds(w, w->order[w->next++], &i0, &j0, &i1, &j1);
+        splinter_homography_tile(w->out, w->layout, w->x0, w->y0,
+                                 i0, j0, i1, j1, w->plan, w->iH);
+        done += (long)(i1-i0)*(j1-j0);
+        if((pixels > 0 && done >= pixels) ||
+           (seconds > 0 && splinter_clock() >= tEnd))
+            break;
+    }
+    w->remaining -= done;
+    return w->remaining;
+}
+
+/// \brief Complete the transform and dispose of its state.
+void splinter_warp_finish(splinter_warp_t* w) {
+    splinter_warp_step(w, 0, 0);
+    splinter_warp_abort(w);
+}
+
+/// \brief Dispose of the state of a transform, leaving the pixels not yet
+/// computed unset.
+void splinter_warp_abort(splinter_warp_t* w) {
+    free(w->order);
+    free(w);
+}
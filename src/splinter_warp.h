@@ -0,0 +1,42 @@
+/**
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ * @file splinter_warp.h
+ * @brief Resumable homography transforms, computed by time slices
+ * @author Thibaud Briand <thibaud.briand@enpc.fr>
+ *         Pascal Monasse <monasse@imagine.enpc.fr>
+ *
+ * Copyright (c) 2017-2025, Thibaud Briand, Pascal Monasse
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Pulic License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPLINTERWARP_H
+#define SPLINTERWARP_H
+
+#include "splinter_transform.h"
+
+/// Opaque state of a resumable transform
+typedef struct splinter_warp_s splinter_warp_t;
+
+splinter_warp_t* splinter_warp_init(void *out, splinter_layout_t layout,
+                                    double x0, double y0, int wo, int ho,
+                                    splinter_plan_t plan, const double homo[9]);
+void splinter_warp_viewport(splinter_warp_t* warp,
+                            int vx, int vy, int vw, int vh);
+long splinter_warp_step(splinter_warp_t* warp, double seconds, long pixels);
+void splinter_warp_finish(splinter_warp_t* warp);
+void splinter_warp_abort(splinter_warp_t* warp);
+
+#endif